@@ -2,24 +2,412 @@
 #include <vector>
 #include <string>
 #include <algorithm>
+#include <cmath>
+#include <random>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <atomic>
 #include "BigInteger++.h"
 
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#elif defined(__GNUC__) && defined(__x86_64__)
+#include <x86intrin.h>
+#endif
+
+//=========================================================================================================================
+// Limb Allocators:
+//=========================================================================================================================
+
+// Each thread has its own allocator, so the threads do not share any memory through it
+static thread_local limbAllocator* currentLimbAllocator = nullptr;
+
+limbAllocator* limbAllocator::GetCurrent()
+{
+	return currentLimbAllocator;
+}
+
+limbAllocator* limbAllocator::SetCurrent(limbAllocator* allocator)
+{
+	limbAllocator* previous = currentLimbAllocator;
+	currentLimbAllocator = allocator;
+	return previous;
+}
+
+limbArena::limbArena(unsigned int blockSize) : blockSize(std::max(blockSize, 1U))
+{
+}
+
+limbArena::~limbArena()
+{
+	Reset();
+}
+
+unsigned long long* limbArena::Allocate(unsigned int count)
+{
+	if (count > remaining) {
+		// A new block (bigger than the usual size if needed), the rest of the current block is not used
+		unsigned int newBlockSize = std::max(count, blockSize);
+		blocks.push_back(new unsigned long long[newBlockSize]);
+		position = blocks.back();
+		remaining = newBlockSize;
+	}
+	unsigned long long* result = position;
+	position += count;
+	remaining -= count;
+	return result;
+}
+
+void limbArena::Deallocate(unsigned long long* /*elements*/, unsigned int /*count*/)
+{
+	// Nothing is freed before Reset()
+}
+
+void limbArena::Reset()
+{
+	for (unsigned long long* block : blocks)
+		delete[] block;
+	blocks.clear();
+	position = nullptr;
+	remaining = 0;
+}
+
+limbPool::~limbPool()
+{
+	Release();
+}
+
+// The smallest k such that (SMALLEST_CLASS << k) >= count, which is SIZE_CLASSES or more for sizes that are not kept
+unsigned int limbPool::SizeClass(unsigned int count)
+{
+	unsigned int sizeClass = 0;
+	while (sizeClass < SIZE_CLASSES && (SMALLEST_CLASS << sizeClass) < count)
+		sizeClass++;
+	return sizeClass;
+}
+
+unsigned long long* limbPool::Allocate(unsigned int count)
+{
+	unsigned int sizeClass = SizeClass(count);
+	if (sizeClass >= SIZE_CLASSES)
+		return new unsigned long long[count];
+	if (freeLists[sizeClass].empty())
+		return new unsigned long long[SMALLEST_CLASS << sizeClass];
+	unsigned long long* result = freeLists[sizeClass].back();
+	freeLists[sizeClass].pop_back();
+	return result;
+}
+
+void limbPool::Deallocate(unsigned long long* elements, unsigned int count)
+{
+	unsigned int sizeClass = SizeClass(count);
+	if (sizeClass >= SIZE_CLASSES)
+		delete[] elements;
+	else
+		freeLists[sizeClass].push_back(elements);
+}
+
+void limbPool::Release()
+{
+	for (std::vector<unsigned long long*>& freeList : freeLists) {
+		for (unsigned long long* elements : freeList)
+			delete[] elements;
+		freeList.clear();
+	}
+}
+
+//=========================================================================================================================
+// Thread Pool:
+//=========================================================================================================================
+
+struct ThreadPoolTask
+{
+	const std::function<void(unsigned int)>* function;
+	unsigned int index;
+	std::atomic<unsigned int>* remaining;	// the tasks of the same ForEach that are not done yet
+};
+
+struct ThreadPoolQueue
+{
+	std::mutex mutex;
+	std::deque<ThreadPoolTask> tasks;
+};
+
+// Each worker thread has its own queue: it pushes and pops its tasks at the back, and the other threads steal from the front.
+// The last queue is shared by the threads that are not workers of the pool.
+struct ThreadPoolState
+{
+	std::vector<std::thread> workers;
+	std::vector<ThreadPoolQueue> queues;
+	std::atomic<unsigned int> pendingTasks{ 0 };	// in all the queues
+	std::mutex sleepMutex;
+	std::condition_variable wakeUp;
+	bool stopping = false;
+
+	ThreadPoolState(unsigned int workerCount) : queues(workerCount + 1) {}
+};
+
+static thread_local threadPool* currentThreadPool = nullptr;
+// The state of the pool that the current thread is a worker of, and the index of its queue
+static thread_local ThreadPoolState* currentWorkerState = nullptr;
+static thread_local unsigned int currentWorkerQueue = 0;
+
+// Takes a task from the given queue first (from its back if it is a worker's own queue), then steals from the front of the others
+static bool TakeThreadPoolTask(ThreadPoolState& state, unsigned int ownQueue, ThreadPoolTask& task)
+{
+	unsigned int queueCount = state.queues.size();
+	if (state.pendingTasks.load(std::memory_order_acquire) == 0)
+		return false;
+	for (unsigned int k = 0; k < queueCount; k++) {
+		ThreadPoolQueue& queue = state.queues[(ownQueue + k) % queueCount];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		if (queue.tasks.empty())
+			continue;
+		if (k == 0 && ownQueue + 1 < queueCount) {
+			task = queue.tasks.back();
+			queue.tasks.pop_back();
+		}
+		else {
+			task = queue.tasks.front();
+			queue.tasks.pop_front();
+		}
+		state.pendingTasks.fetch_sub(1, std::memory_order_relaxed);
+		return true;
+	}
+	return false;
+}
+
+static void RunThreadPoolTask(const ThreadPoolTask& task)
+{
+	(*task.function)(task.index);
+	task.remaining->fetch_sub(1, std::memory_order_release);
+}
+
+static void ThreadPoolWorker(threadPool* pool, ThreadPoolState* state, unsigned int queue)
+{
+	threadPool::SetCurrent(pool);
+	currentWorkerState = state;
+	currentWorkerQueue = queue;
+	ThreadPoolTask task;
+	while (true) {
+		if (TakeThreadPoolTask(*state, queue, task)) {
+			RunThreadPoolTask(task);
+			continue;
+		}
+		std::unique_lock<std::mutex> lock(state->sleepMutex);
+		state->wakeUp.wait(lock, [state] { return state->stopping || state->pendingTasks.load() > 0; });
+		if (state->stopping && state->pendingTasks.load() == 0)
+			return;
+	}
+}
+
+threadPool::threadPool(unsigned int threads, unsigned int parallelThreshold) : parallelThreshold(parallelThreshold)
+{
+	if (threads == 0)
+		threads = std::max(std::thread::hardware_concurrency(), 1U);
+	// The calling thread of ForEach is one of the threads
+	state = new ThreadPoolState(threads - 1);
+	for (unsigned int i = 0; i + 1 < threads; i++)
+		state->workers.emplace_back(ThreadPoolWorker, this, state, i);
+}
+
+threadPool::~threadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(state->sleepMutex);
+		state->stopping = true;
+	}
+	state->wakeUp.notify_all();
+	for (std::thread& worker : state->workers)
+		worker.join();
+	delete state;
+}
+
+unsigned int threadPool::GetThreads() const
+{
+	return state->workers.size() + 1;
+}
+
+unsigned int threadPool::GetParallelThreshold() const
+{
+	return parallelThreshold;
+}
+
+void threadPool::SetParallelThreshold(unsigned int parallelThreshold)
+{
+	this->parallelThreshold = parallelThreshold;
+}
+
+void threadPool::ForEach(unsigned int count, const std::function<void(unsigned int)>& task)
+{
+	if (count == 0)
+		return;
+	if (count == 1 || state->workers.empty()) {
+		for (unsigned int i = 0; i < count; i++)
+			task(i);
+		return;
+	}
+
+	// The tasks are pushed in reverse, so the owner pops them in order (and the thieves steal the last ones first)
+	std::atomic<unsigned int> remaining(count);
+	unsigned int ownQueue = currentWorkerState == state ? currentWorkerQueue : state->workers.size();
+	state->pendingTasks.fetch_add(count, std::memory_order_release);
+	{
+		ThreadPoolQueue& queue = state->queues[ownQueue];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		for (unsigned int i = count; i > 0; i--)
+			queue.tasks.push_back({ &task, i - 1, &remaining });
+	}
+	{
+		std::lock_guard<std::mutex> lock(state->sleepMutex); // a worker is either waiting already or it sees the new tasks
+	}
+	state->wakeUp.notify_all();
+
+	// Working on any task of the pool until all of these are done (the others might be parts of them)
+	ThreadPoolTask other;
+	while (remaining.load(std::memory_order_acquire) > 0) {
+		if (TakeThreadPoolTask(*state, ownQueue, other))
+			RunThreadPoolTask(other);
+		else
+			std::this_thread::yield();
+	}
+}
+
+threadPool* threadPool::GetCurrent()
+{
+	return currentThreadPool;
+}
+
+threadPool* threadPool::SetCurrent(threadPool* pool)
+{
+	threadPool* previous = currentThreadPool;
+	currentThreadPool = pool;
+	return previous;
+}
+
+//=========================================================================================================================
+// Limb Storage:
+//=========================================================================================================================
+
+limbVector::limbVector(const limbVector& other) : limbVector()
+{
+	assign(other.elements, other.count);
+}
+
+limbVector::limbVector(limbVector&& other) noexcept : limbVector()
+{
+	(*this) = std::move(other);
+}
+
+limbVector::~limbVector()
+{
+	Release();
+}
+
+limbVector& limbVector::operator=(const limbVector& other)
+{
+	if (this != &other)
+		assign(other.elements, other.count);
+	return *this;
+}
+
+limbVector& limbVector::operator=(limbVector&& other) noexcept
+{
+	if (this == &other)
+		return *this;
+	Release();
+	if (other.IsInline()) {
+		// Inline elements cannot be taken, they are copied instead (at most INLINE_LIMBS elements)
+		std::copy(other.elements, other.elements + other.count, inlineElements);
+		count = other.count;
+	}
+	else {
+		// The memory is taken together with its allocator
+		elements = other.elements;
+		count = other.count;
+		capacity = other.capacity;
+		allocator = other.allocator;
+		other.elements = other.inlineElements;
+		other.capacity = INLINE_LIMBS;
+		other.allocator = nullptr;
+	}
+	other.count = 0;
+	return *this;
+}
+
+void limbVector::resize(unsigned int newSize)
+{
+	if (newSize > capacity)
+		reserve(std::max(newSize, 2 * capacity));
+	if (newSize > count)
+		std::fill(elements + count, elements + newSize, 0);
+	count = newSize;
+}
+
+void limbVector::reserve(unsigned int newCapacity)
+{
+	if (newCapacity <= capacity)
+		return;
+	limbAllocator* newAllocator = limbAllocator::GetCurrent();
+	unsigned long long* newElements = newAllocator ? newAllocator->Allocate(newCapacity) : new unsigned long long[newCapacity];
+	std::copy(elements, elements + count, newElements);
+	Release();
+	elements = newElements;
+	capacity = newCapacity;
+	allocator = newAllocator;
+}
+
+void limbVector::assign(const unsigned long long* values, unsigned int size)
+{
+	if (size > capacity) {
+		// The old elements are not needed, so they are not copied to the new place
+		count = 0;
+		reserve(size);
+	}
+	std::copy(values, values + size, elements);
+	count = size;
+}
+
+void limbVector::swap(limbVector& other)
+{
+	if (this == &other)
+		return;
+	limbVector temporary(std::move(other));
+	other = std::move(*this);
+	(*this) = std::move(temporary);
+}
+
+// Frees the heap memory (if any) and goes back to the inline elements, the count is not changed
+void limbVector::Release()
+{
+	if (!IsInline()) {
+		if (allocator)
+			allocator->Deallocate(elements, capacity);
+		else
+			delete[] elements;
+	}
+	elements = inlineElements;
+	capacity = INLINE_LIMBS;
+	allocator = nullptr;
+}
+
 //=========================================================================================================================
 // Constructors and Destructor
 //=========================================================================================================================
 
 unsignedBigInteger::unsignedBigInteger()
 {
+	// decimalContents is left empty until it is needed (see ConvertToDecimal)
 	Resize(1);
 	binaryContents[0] = 0;
-	decimalContents.resize(1);
-	decimalContents[0] = 0;
-	isConvertedToDecimal = true;
 }
 
 unsignedBigInteger::unsignedBigInteger(const unsignedBigInteger& other)
 {
 	binaryContents = other.binaryContents;
+	MAX_SIZE = other.MAX_SIZE;
 
 	if (other.isConvertedToDecimal) {
 		decimalContents = other.decimalContents;
@@ -27,6 +415,19 @@ unsignedBigInteger::unsignedBigInteger(const unsignedBigInteger& other)
 	}
 }
 
+unsignedBigInteger::unsignedBigInteger(unsignedBigInteger&& other) noexcept
+{
+	// The contents are taken from (other) without copying
+	binaryContents.swap(other.binaryContents);
+	decimalContents.swap(other.decimalContents);
+	MAX_SIZE = other.MAX_SIZE;
+	isConvertedToDecimal = other.isConvertedToDecimal;
+	other.isConvertedToDecimal = false;
+
+	// (other) is left as a valid 0 (a single element, which is kept inline)
+	other.binaryContents.resize(1);
+}
+
 unsignedBigInteger::unsignedBigInteger(unsigned long long other)
 {
 	Resize(1);
@@ -47,8 +448,7 @@ unsignedBigInteger::unsignedBigInteger(std::string str, int base)
 
 unsignedBigInteger::~unsignedBigInteger()
 {
-	binaryContents.~vector();
-	decimalContents.~vector();
+	// Both vectors release their memory by themselves
 }
 
 //=========================================================================================================================
@@ -58,32 +458,2389 @@ unsignedBigInteger::~unsignedBigInteger()
 unsignedBigInteger& unsignedBigInteger::operator=(const unsignedBigInteger& other)
 {
 	binaryContents = other.binaryContents;
+	MAX_SIZE = other.MAX_SIZE;
 
 	if (other.isConvertedToDecimal) {
 		decimalContents = other.decimalContents;
 		isConvertedToDecimal = true;
 	}
-	else isConvertedToDecimal = false;
+	else isConvertedToDecimal = false;
+
+	return *this;
+}
+
+unsignedBigInteger& unsignedBigInteger::operator=(unsignedBigInteger&& other) noexcept
+{
+	// The contents are exchanged without copying, so the old contents of (*this) are released with (other)
+	binaryContents.swap(other.binaryContents);
+	decimalContents.swap(other.decimalContents);
+	std::swap(MAX_SIZE, other.MAX_SIZE);
+	std::swap(isConvertedToDecimal, other.isConvertedToDecimal);
+	return *this;
+}
+
+unsignedBigInteger& unsignedBigInteger::operator=(unsigned long long other)
+{
+	isConvertedToDecimal = false; // decimalContents will not represent the new value
+	Resize(1);
+	binaryContents[0] = other;
+	return *this;
+}
+
+// This function accesses the binary contents by reference (easier code)
+// Any function that changes the value through it must set (isConvertedToDecimal) to false
+unsigned long long& unsignedBigInteger::operator[](unsigned int binaryContentsIndex)
+{
+	return binaryContents[binaryContentsIndex];
+}
+
+unsigned long long unsignedBigInteger::operator[](unsigned int binaryContentsIndex) const
+{
+	return binaryContents[binaryContentsIndex];
+}
+
+//=========================================================================================================================
+// Internal Limb Kernels:
+//
+// These functions work directly on arrays of 64-bit limbs (the same layout as binaryContents, starting from 0 at least
+// significant), so the operators can run them on the vectors' data without creating temporary big integers.
+// Unless stated otherwise, an output array must not overlap any of the input arrays.
+//=========================================================================================================================
+
+// Operand sizes (in 64-bit limbs) from which multiplication moves on to the next algorithm:
+// [schoolbook] -> KARATSUBA_THRESHOLD -> [Karatsuba] -> TOOM3_THRESHOLD -> [Toom-Cook 3-way] -> NTT_THRESHOLD -> [NTT]
+constexpr unsigned int KARATSUBA_THRESHOLD	= 32;
+constexpr unsigned int TOOM3_THRESHOLD		= 192;
+constexpr unsigned int NTT_THRESHOLD		= 4096;
+
+// Number of elements from which the loops of a parallel NTT are split into ranges for the threads of the pool
+// (and the transforms into independent halves), so each range is still big enough to be worth a task
+constexpr unsigned int NTT_PARALLEL_RANGE	= 8192;
+
+// Divisor sizes (in 64-bit limbs) from which division moves on to the next algorithm (the quotient must be that large too):
+// [Knuth's Algorithm D] -> BURNIKEL_ZIEGLER_THRESHOLD -> [Burnikel-Ziegler] -> NEWTON_THRESHOLD -> [Newton's reciprocal]
+constexpr unsigned int BURNIKEL_ZIEGLER_THRESHOLD	= 64;
+constexpr unsigned int NEWTON_THRESHOLD				= 32768;
+
+// Number sizes (in 64-bit limbs) from which the conversions to and from decimal are split recursively by powers of 10
+constexpr unsigned int DECIMAL_CONVERSION_THRESHOLD	= 64;
+
+// Modulus sizes (in 64-bit limbs) from which the Montgomery reduction is done by 2 multiplications instead of limb by limb,
+// and Barrett's reduction uses full products by MultiplyLimbs instead of calculating only the needed half of schoolbook products
+constexpr unsigned int MONTGOMERY_REDC_THRESHOLD	= 128;
+constexpr unsigned int BARRETT_HALF_PRODUCT_THRESHOLD	= 128;
+
+// Number sizes (in 64-bit limbs) from which the GCD moves on to the next algorithm:
+// [binary (single limb)] -> [Lehmer] -> GCD_HALF_GCD_THRESHOLD -> [half-GCD], where the half-GCD itself recurses from HALF_GCD_THRESHOLD
+constexpr unsigned int HALF_GCD_THRESHOLD		= 128;
+constexpr unsigned int GCD_HALF_GCD_THRESHOLD	= 384;
+
+// Small primes: IsProbablePrime divides by the primes below TRIAL_DIVISION_LIMIT before Miller-Rabin,
+// and NextPrime sieves windows of SIEVE_WINDOW odd numbers by the primes below SIEVE_LIMIT
+constexpr unsigned int TRIAL_DIVISION_LIMIT		= 1024;
+constexpr unsigned int SIEVE_LIMIT				= 32768;
+constexpr unsigned int SIEVE_WINDOW				= 4096;
+
+// Leaves of the product trees (in limbs), which are multiplied by one limb at a time
+constexpr unsigned int PRODUCT_TREE_LEAF		= 16;
+
+static_assert(KARATSUBA_THRESHOLD >= 4, "Karatsuba needs at least 4 limbs to split the operands into smaller halves");
+static_assert(TOOM3_THRESHOLD >= 3 * KARATSUBA_THRESHOLD, "Toom-3 parts should not be smaller than the Karatsuba threshold");
+
+// Returns the lower 64 bits of (a * b), and stores the higher 64 bits in (high)
+static inline unsigned long long MultiplyWide(unsigned long long a, unsigned long long b, unsigned long long& high)
+{
+#if defined(__SIZEOF_INT128__)
+	// Compiled to mul (or mulx with BMI2 enabled)
+	unsigned __int128 product = (unsigned __int128)a * b;
+	high = (unsigned long long)(product >> 64);
+	return (unsigned long long)product;
+#elif defined(_MSC_VER) && defined(_M_X64) && defined(__AVX2__)
+	// mulx (BMI2 comes with every AVX2 processor), which does not change the carry flag of the surrounding additions
+	return _mulx_u64(a, b, &high);
+#elif defined(_MSC_VER) && defined(_M_X64)
+	return _umul128(a, b, &high);
+#else
+	// Multiplying the 32-bit halves: (aH * 2^32 + aL) * (bH * 2^32 + bL)
+	unsigned long long aL = a & LOW_DWORD, aH = a >> 32, bL = b & LOW_DWORD, bH = b >> 32;
+	unsigned long long low = aL * bL, middle1 = aH * bL, middle2 = aL * bH;
+	unsigned long long middle = (low >> 32) + (middle1 & LOW_DWORD) + (middle2 & LOW_DWORD);
+	high = aH * bH + (middle1 >> 32) + (middle2 >> 32) + (middle >> 32);
+	return (middle << 32) | (low & LOW_DWORD);
+#endif
+}
+
+// Returns -odd^-1 mod 2^64 (for the Montgomery reduction)
+static inline unsigned long long NegativeInverseOfLimb(unsigned long long odd)
+{
+	// Newton's iteration doubles the correct bits of the inverse each step (an odd number is its own inverse modulo 2^3)
+	unsigned long long inverse = odd;
+	for (unsigned int i = 0; i < 5; i++)
+		inverse *= 2 - odd * inverse;
+	return 0 - inverse;
+}
+
+// result = a + b + carry, returns the carry out (0 or 1). On x86-64 this is a single adc instruction.
+static inline unsigned char AddWithCarry(unsigned char carry, unsigned long long a, unsigned long long b, unsigned long long& result)
+{
+#if (defined(_MSC_VER) && defined(_M_X64)) || (defined(__GNUC__) && defined(__x86_64__))
+	unsigned long long sum;
+	carry = _addcarry_u64(carry, a, b, &sum);
+	result = sum;
+	return carry;
+#elif defined(__SIZEOF_INT128__)
+	unsigned __int128 sum = (unsigned __int128)a + b + carry;
+	result = (unsigned long long)sum;
+	return (unsigned char)(sum >> 64);
+#else
+	unsigned long long sum = a + carry;
+	unsigned char carryOut = sum < carry;
+	result = sum + b;
+	return carryOut | (result < sum);
+#endif
+}
+
+// result = a - b - borrow, returns the borrow out (0 or 1). On x86-64 this is a single sbb instruction.
+static inline unsigned char SubtractWithBorrow(unsigned char borrow, unsigned long long a, unsigned long long b, unsigned long long& result)
+{
+#if (defined(_MSC_VER) && defined(_M_X64)) || (defined(__GNUC__) && defined(__x86_64__))
+	unsigned long long difference;
+	borrow = _subborrow_u64(borrow, a, b, &difference);
+	result = difference;
+	return borrow;
+#elif defined(__SIZEOF_INT128__)
+	unsigned __int128 difference = (unsigned __int128)a - b - borrow;
+	result = (unsigned long long)difference;
+	return (unsigned char)(difference >> 64) & 1;
+#else
+	unsigned long long difference = a - b;
+	unsigned char borrowOut = a < b;
+	result = difference - borrow;
+	return borrowOut | (difference < borrow);
+#endif
+}
+
+// Returns the lower 64 bits of (a * b + c + d), and stores the higher 64 bits in (high). The result always fits in 128 bits.
+static inline unsigned long long MultiplyAddWide(unsigned long long a, unsigned long long b, unsigned long long c, unsigned long long d,
+	unsigned long long& high)
+{
+#if defined(__SIZEOF_INT128__)
+	unsigned __int128 result = (unsigned __int128)a * b + c + d;
+	high = (unsigned long long)(result >> 64);
+	return (unsigned long long)result;
+#else
+	unsigned long long low = MultiplyWide(a, b, high);
+	high += AddWithCarry(0, low, c, low);
+	high += AddWithCarry(0, low, d, low);
+	return low;
+#endif
+}
+
+// Returns the number of leading zero bits of a 64-bit integer (64 for 0)
+static inline unsigned int CountLeadingZeros(unsigned long long value)
+{
+	if (value == 0)
+		return 64;
+#if defined(__GNUC__)
+	return __builtin_clzll(value);
+#elif defined(_MSC_VER) && defined(_M_X64)
+	unsigned long index;
+	_BitScanReverse64(&index, value);
+	return 63 - index;
+#else
+	unsigned int result = 0;
+	while ((value & (1ULL << 63)) == 0) {
+		value <<= 1;
+		result++;
+	}
+	return result;
+#endif
+}
+
+// Returns the number of trailing zero bits of a 64-bit integer (64 for 0)
+static inline unsigned int CountTrailingZeros(unsigned long long value)
+{
+	if (value == 0)
+		return 64;
+#if defined(__GNUC__)
+	return __builtin_ctzll(value);
+#elif defined(_MSC_VER) && defined(_M_X64)
+	unsigned long index;
+	_BitScanForward64(&index, value);
+	return index;
+#else
+	unsigned int result = 0;
+	while ((value & 1) == 0) {
+		value >>= 1;
+		result++;
+	}
+	return result;
+#endif
+}
+
+// Returns ((high * 2^64 + low) / divisor), and stores the remainder in (remainder), where (high < divisor) so the quotient fits in 64 bits
+static inline unsigned long long DivideWide(unsigned long long high, unsigned long long low, unsigned long long divisor,
+	unsigned long long& remainder)
+{
+#if defined(__GNUC__) && defined(__x86_64__)
+	unsigned long long quotient;
+	__asm__("divq %4" : "=a"(quotient), "=d"(remainder) : "a"(low), "d"(high), "rm"(divisor));
+	return quotient;
+#elif defined(__SIZEOF_INT128__)
+	unsigned __int128 dividend = ((unsigned __int128)high << 64) | low;
+	remainder = (unsigned long long)(dividend % divisor);
+	return (unsigned long long)(dividend / divisor);
+#elif defined(_MSC_VER) && defined(_M_X64) && (_MSC_VER >= 1920)
+	return _udiv128(high, low, divisor, &remainder);
+#else
+	/*	Dividing by 32-bit digits (Knuth's Algorithm D with 2 digits of quotient):
+	*	The divisor is normalized (shifted so its highest bit is 1), so each estimated digit is at most 2 more than the actual one.
+	*/
+	const unsigned long long digitBase = 1ULL << 32;
+	unsigned int shift = CountLeadingZeros(divisor);
+	divisor <<= shift;
+	unsigned long long divisorHigh = divisor >> 32, divisorLow = divisor & LOW_DWORD;
+	unsigned long long dividendHigh = shift == 0 ? high : (high << shift) | (low >> (64 - shift));
+	unsigned long long dividendLow = low << shift;
+	unsigned long long digit1 = dividendLow >> 32, digit0 = dividendLow & LOW_DWORD;
+
+	unsigned long long quotientHigh = dividendHigh / divisorHigh, partial = dividendHigh - quotientHigh * divisorHigh;
+	while (quotientHigh >= digitBase || quotientHigh * divisorLow > ((partial << 32) | digit1)) {
+		quotientHigh--;
+		partial += divisorHigh;
+		if (partial >= digitBase)
+			break;
+	}
+	unsigned long long middle = (dividendHigh << 32) + digit1 - quotientHigh * divisor;
+
+	unsigned long long quotientLow = middle / divisorHigh;
+	partial = middle - quotientLow * divisorHigh;
+	while (quotientLow >= digitBase || quotientLow * divisorLow > ((partial << 32) | digit0)) {
+		quotientLow--;
+		partial += divisorHigh;
+		if (partial >= digitBase)
+			break;
+	}
+	remainder = ((middle << 32) + digit0 - quotientLow * divisor) >> shift;
+	return (quotientHigh << 32) | quotientLow;
+#endif
+}
+
+/*	Division by an invariant 64-bit divisor ("Improved division by invariant integers", Moller and Granlund, Algorithm 4):
+*	For a normalized divisor d (highest bit is 1), the reciprocal v = (2^128 - 1) / d - 2^64 is computed once,
+*	then each 128-bit by 64-bit division needs only 2 multiplications and a few additions instead of a hardware division.
+*/
+static inline unsigned long long ReciprocalOfLimb(unsigned long long divisor)
+{
+	// (2^128 - 1 - divisor * 2^64) / divisor, where (~divisor < divisor) as divisor is normalized
+	unsigned long long remainder;
+	return DivideWide(~divisor, ~0ULL, divisor, remainder);
+}
+
+// Returns ((high * 2^64 + low) / divisor), and stores the remainder in (remainder),
+// where divisor is normalized, (high < divisor), and reciprocal = ReciprocalOfLimb(divisor)
+static inline unsigned long long DivideWideByReciprocal(unsigned long long high, unsigned long long low,
+	unsigned long long divisor, unsigned long long reciprocal, unsigned long long& remainder)
+{
+	// (quotient : fraction) = reciprocal * high + (high + 1 : low)
+	unsigned long long quotient, fraction = MultiplyWide(reciprocal, high, quotient);
+	fraction += low;
+	quotient += high + 1 + (fraction < low);
+
+	// The candidate remainder is computed modulo 2^64, and the quotient is off by at most 1 in each direction
+	remainder = low - quotient * divisor;
+	if (remainder > fraction) {
+		quotient--;
+		remainder += divisor;
+	}
+	if (remainder >= divisor) {
+		quotient++;
+		remainder -= divisor;
+	}
+	return quotient;
+}
+
+// Propagates a carry from result[i] up to result[size - 1], copying the rest of a if result is not a. Returns the final carry.
+static inline unsigned long long PropagateCarry(unsigned long long* result, const unsigned long long* a, unsigned int i, unsigned int size,
+	unsigned char carry)
+{
+	for (; i < size && carry; i++)
+		carry = AddWithCarry(carry, a[i], 0, result[i]);
+	if (result != a)
+		std::copy(a + i, a + size, result + i);
+	return carry;
+}
+
+// Same as PropagateCarry, for a borrow
+static inline unsigned long long PropagateBorrow(unsigned long long* result, const unsigned long long* a, unsigned int i, unsigned int size,
+	unsigned char borrow)
+{
+	for (; i < size && borrow; i++)
+		borrow = SubtractWithBorrow(borrow, a[i], 0, result[i]);
+	if (result != a)
+		std::copy(a + i, a + size, result + i);
+	return borrow;
+}
+
+// result = a + b, where (aSize >= bSize) and result has room for aSize limbs. Returns the final carry.
+// result may be the same array as a or b (in-place addition), since each limb is read before it is written.
+static unsigned long long AddLimbs(unsigned long long* result, const unsigned long long* a, unsigned int aSize,
+	const unsigned long long* b, unsigned int bSize)
+{
+	// A single carry chain, unrolled by 4 so the compiler can keep the carry in the flags
+	unsigned char carry = 0;
+	unsigned int i = 0;
+	for (; i + 4 <= bSize; i += 4) {
+		carry = AddWithCarry(carry, a[i], b[i], result[i]);
+		carry = AddWithCarry(carry, a[i + 1], b[i + 1], result[i + 1]);
+		carry = AddWithCarry(carry, a[i + 2], b[i + 2], result[i + 2]);
+		carry = AddWithCarry(carry, a[i + 3], b[i + 3], result[i + 3]);
+	}
+	for (; i < bSize; i++)
+		carry = AddWithCarry(carry, a[i], b[i], result[i]);
+	return PropagateCarry(result, a, bSize, aSize, carry);
+}
+
+// result = a - b, where (aSize >= bSize) and result has room for aSize limbs. Returns the final borrow.
+// result may be the same array as a or b (in-place subtraction), since each limb is read before it is written.
+static unsigned long long SubtractLimbs(unsigned long long* result, const unsigned long long* a, unsigned int aSize,
+	const unsigned long long* b, unsigned int bSize)
+{
+	unsigned char borrow = 0;
+	unsigned int i = 0;
+	for (; i + 4 <= bSize; i += 4) {
+		borrow = SubtractWithBorrow(borrow, a[i], b[i], result[i]);
+		borrow = SubtractWithBorrow(borrow, a[i + 1], b[i + 1], result[i + 1]);
+		borrow = SubtractWithBorrow(borrow, a[i + 2], b[i + 2], result[i + 2]);
+		borrow = SubtractWithBorrow(borrow, a[i + 3], b[i + 3], result[i + 3]);
+	}
+	for (; i < bSize; i++)
+		borrow = SubtractWithBorrow(borrow, a[i], b[i], result[i]);
+	return PropagateBorrow(result, a, bSize, aSize, borrow);
+}
+
+// result = a + value, where (size >= 1) and result has room for size limbs. Returns the final carry.
+// result may be the same array as a.
+static unsigned long long AddLimb(unsigned long long* result, const unsigned long long* a, unsigned int size, unsigned long long value)
+{
+	unsigned char carry = AddWithCarry(0, a[0], value, result[0]);
+	return PropagateCarry(result, a, 1, size, carry);
+}
+
+// result = a - value, where (size >= 1) and result has room for size limbs. Returns the final borrow.
+// result may be the same array as a.
+static unsigned long long SubtractLimb(unsigned long long* result, const unsigned long long* a, unsigned int size, unsigned long long value)
+{
+	unsigned char borrow = SubtractWithBorrow(0, a[0], value, result[0]);
+	return PropagateBorrow(result, a, 1, size, borrow);
+}
+
+// 0 = equals, +1 = greater, -1 = smaller (same as CompareWith, but leading zero limbs are allowed)
+static signed int CompareLimbs(const unsigned long long* a, unsigned int aSize, const unsigned long long* b, unsigned int bSize)
+{
+	while (aSize > bSize)
+		if (a[--aSize] != 0)
+			return 1;
+	while (bSize > aSize)
+		if (b[--bSize] != 0)
+			return -1;
+	while (aSize-- > 0) {
+		if (a[aSize] > b[aSize])
+			return 1;
+		if (a[aSize] < b[aSize])
+			return -1;
+	}
+	return 0;
+}
+
+// result[0 .. size) = a[0 .. size) * multiplier + carry. Returns the limb carried out of the top. (mul_1)
+// result may be the same array as a (in-place multiplication).
+static unsigned long long MultiplyRow(unsigned long long* result, const unsigned long long* a, unsigned int size,
+	unsigned long long multiplier, unsigned long long carry = 0)
+{
+	unsigned int i = 0;
+	for (; i + 2 <= size; i += 2) {
+		result[i] = MultiplyAddWide(a[i], multiplier, carry, 0, carry);
+		result[i + 1] = MultiplyAddWide(a[i + 1], multiplier, carry, 0, carry);
+	}
+	if (i < size)
+		result[i] = MultiplyAddWide(a[i], multiplier, carry, 0, carry);
+	return carry;
+}
+
+// result[0 .. size) += a[0 .. size) * multiplier. Returns the limb carried out of the top. (addmul_1)
+static unsigned long long MultiplyAddRow(unsigned long long* result, const unsigned long long* a, unsigned int size,
+	unsigned long long multiplier)
+{
+	// Each step is a[i] * multiplier + result[i] + carry, which cannot overflow 128 bits, so the carry is just the higher half
+	unsigned long long carry = 0;
+	unsigned int i = 0;
+	for (; i + 2 <= size; i += 2) {
+		result[i] = MultiplyAddWide(a[i], multiplier, result[i], carry, carry);
+		result[i + 1] = MultiplyAddWide(a[i + 1], multiplier, result[i + 1], carry, carry);
+	}
+	if (i < size)
+		result[i] = MultiplyAddWide(a[i], multiplier, result[i], carry, carry);
+	return carry;
+}
+
+// result[0 .. size) -= a[0 .. size) * multiplier. Returns the limb borrowed from above the top. (submul_1)
+static unsigned long long MultiplySubtractRow(unsigned long long* result, const unsigned long long* a, unsigned int size,
+	unsigned long long multiplier)
+{
+	unsigned long long borrow = 0, high;
+	for (unsigned int i = 0; i < size; i++) {
+		unsigned long long low = MultiplyAddWide(a[i], multiplier, borrow, 0, high);
+		borrow = high + SubtractWithBorrow(0, result[i], low, result[i]);
+	}
+	return borrow;
+}
+
+// Schoolbook multiplication: result[0 .. aSize + bSize) = a * b
+static void MultiplyBasecase(const unsigned long long* a, unsigned int aSize, const unsigned long long* b, unsigned int bSize,
+	unsigned long long* result)
+{
+	std::fill(result, result + aSize + bSize, 0ULL);
+	for (unsigned int j = 0; j < bSize; j++)
+		result[aSize + j] = MultiplyAddRow(result + j, a, aSize, b[j]);
+}
+
+/*	Schoolbook squaring: result[0 .. 2*size) = a * a
+*	Each cross product a[i] * a[j] (i < j) appears twice in the square, so they are only calculated once (half of the rows),
+*	then the sum is doubled by a 1-bit shift, and the squares a[i] * a[i] are added on the diagonal.
+*/
+static void SquareBasecase(const unsigned long long* a, unsigned int size, unsigned long long* result)
+{
+	std::fill(result, result + 2 * size, 0ULL);
+	for (unsigned int i = 0; i + 1 < size; i++)
+		result[i + size] = MultiplyAddRow(result + 2 * i + 1, a + i + 1, size - i - 1, a[i]);
+
+	for (unsigned int i = 2 * size - 1; i > 0; i--)
+		result[i] = (result[i] << 1) | (result[i - 1] >> 63);
+	result[0] <<= 1;
+
+	unsigned char carry = 0;
+	for (unsigned int i = 0; i < size; i++) {
+		unsigned long long high, low = MultiplyWide(a[i], a[i], high);
+		carry = AddWithCarry(carry, result[2 * i], low, result[2 * i]);
+		carry = AddWithCarry(carry, result[2 * i + 1], high, result[2 * i + 1]);
+	}
+}
+
+static void MultiplyBalanced(const unsigned long long* a, const unsigned long long* b, unsigned int size,
+	unsigned long long* result, unsigned long long* scratch);
+static void SquareBalanced(const unsigned long long* a, unsigned int size, unsigned long long* result, unsigned long long* scratch);
+static void MultiplyLimbs(const unsigned long long* a, unsigned int aSize, const unsigned long long* b, unsigned int bSize,
+	unsigned long long* result);
+static void SquareLimbs(const unsigned long long* a, unsigned int size, unsigned long long* result);
+
+// Number of scratch limbs needed by MultiplyKaratsuba for two numbers of (size) limbs each (including all recursion levels)
+static unsigned int KaratsubaScratchSize(unsigned int size)
+{
+	unsigned int result = 0;
+	while (size >= KARATSUBA_THRESHOLD && size < TOOM3_THRESHOLD) {
+		unsigned int highSize = size - (size >> 1);
+		result += 4 * (highSize + 1);
+		size = highSize + 1;
+	}
+	return result;
+}
+
+/*	Karatsuba multiplication: result[0 .. 2*size) = a * b, where both a and b have (size) limbs.
+*	Let X = 2^(64*lowSize), a = a1 * X + a0, b = b1 * X + b0
+*	Then a * b = z2 * X^2 + z1 * X + z0 where:
+*	- z0 = a0 * b0
+*	- z2 = a1 * b1
+*	- z1 = (a0 + a1) * (b0 + b1) - z0 - z2
+*	So only 3 half-sized multiplications are needed instead of 4.
+*	z0 and z2 are written directly to their places in the result, and z1 is added over them afterwards.
+*/
+static void MultiplyKaratsuba(const unsigned long long* a, const unsigned long long* b, unsigned int size,
+	unsigned long long* result, unsigned long long* scratch)
+{
+	unsigned int lowSize = size >> 1, highSize = size - lowSize; // highSize >= lowSize
+
+	MultiplyBalanced(a, b, lowSize, result, scratch);
+	MultiplyBalanced(a + lowSize, b + lowSize, highSize, result + 2 * lowSize, scratch);
+
+	// The sums may have an extra limb for the carry
+	unsigned long long* sumA = scratch;
+	unsigned long long* sumB = sumA + highSize + 1;
+	unsigned long long* middle = sumB + highSize + 1;
+	unsigned long long* nextScratch = middle + 2 * (highSize + 1);
+	sumA[highSize] = AddLimbs(sumA, a + lowSize, highSize, a, lowSize);
+	sumB[highSize] = AddLimbs(sumB, b + lowSize, highSize, b, lowSize);
+	MultiplyBalanced(sumA, sumB, highSize + 1, middle, nextScratch);
+
+	unsigned int middleSize = 2 * (highSize + 1);
+	SubtractLimbs(middle, middle, middleSize, result, 2 * lowSize);
+	SubtractLimbs(middle, middle, middleSize, result + 2 * lowSize, 2 * highSize);
+
+	// z1 fits in (size + highSize) limbs, the remaining leading limbs of middle are zeros by now
+	unsigned int restSize = 2 * size - lowSize;
+	AddLimbs(result + lowSize, result + lowSize, restSize, middle, std::min(middleSize, restSize));
+}
+
+// Karatsuba squaring: the same as MultiplyKaratsuba with b = a, so the 3 half-sized multiplications are squares
+static void SquareKaratsuba(const unsigned long long* a, unsigned int size, unsigned long long* result, unsigned long long* scratch)
+{
+	unsigned int lowSize = size >> 1, highSize = size - lowSize;
+
+	SquareBalanced(a, lowSize, result, scratch);
+	SquareBalanced(a + lowSize, highSize, result + 2 * lowSize, scratch);
+
+	// The same scratch layout as MultiplyKaratsuba (the place of the second sum is not used)
+	unsigned long long* sum = scratch;
+	unsigned long long* middle = sum + 2 * (highSize + 1);
+	unsigned long long* nextScratch = middle + 2 * (highSize + 1);
+	sum[highSize] = AddLimbs(sum, a + lowSize, highSize, a, lowSize);
+	SquareBalanced(sum, highSize + 1, middle, nextScratch);
+
+	unsigned int middleSize = 2 * (highSize + 1);
+	SubtractLimbs(middle, middle, middleSize, result, 2 * lowSize);
+	SubtractLimbs(middle, middle, middleSize, result + 2 * lowSize, 2 * highSize);
+
+	unsigned int restSize = 2 * size - lowSize;
+	AddLimbs(result + lowSize, result + lowSize, restSize, middle, std::min(middleSize, restSize));
+}
+
+// The thread pool of the current thread if a product of operands of (size) limbs should be split across its threads, otherwise nullptr
+static threadPool* ParallelPoolFor(unsigned int size)
+{
+	threadPool* pool = threadPool::GetCurrent();
+	if (pool == nullptr || pool->GetThreads() < 2 || size < pool->GetParallelThreshold())
+		return nullptr;
+	return pool;
+}
+
+// Calls task(begin, end) for consecutive ranges that cover [0, count), on the threads of the pool if it is not nullptr.
+// Each range has at least (minimumRange) elements, and there are a few ranges for each thread to balance the load.
+static void ParallelRanges(threadPool* pool, unsigned int count, unsigned int minimumRange,
+	const std::function<void(unsigned int, unsigned int)>& task)
+{
+	unsigned int ranges = pool == nullptr ? 1 : std::min(count / minimumRange, 4 * pool->GetThreads());
+	if (ranges <= 1) {
+		task(0, count);
+		return;
+	}
+	pool->ForEach(ranges, [&](unsigned int i) {
+		task((unsigned long long)count * i / ranges, (unsigned long long)count * (i + 1) / ranges);
+	});
+}
+
+// A signed number that is only needed for the intermediate values of Toom-3 (evaluations and interpolation)
+struct SignedLimbs
+{
+	std::vector<unsigned long long> limbs;	// the absolute value (at least 1 element)
+	bool negative = false;
+};
+
+static void TrimLimbs(std::vector<unsigned long long>& limbs)
+{
+	while (limbs.size() > 1 && limbs.back() == 0)
+		limbs.pop_back();
+}
+
+static SignedLimbs ToSignedLimbs(const unsigned long long* limbs, unsigned int size)
+{
+	SignedLimbs result;
+	result.limbs.assign(limbs, limbs + size);
+	TrimLimbs(result.limbs);
+	return result;
+}
+
+// result = x + y (or x - y if subtract is true)
+static SignedLimbs SignedAdd(const SignedLimbs& x, const SignedLimbs& y, bool subtract = false)
+{
+	bool yNegative = y.negative != subtract;
+	const std::vector<unsigned long long>* greater = &x.limbs;
+	const std::vector<unsigned long long>* smaller = &y.limbs;
+	SignedLimbs result;
+	if (x.negative == yNegative) {
+		if (greater->size() < smaller->size())
+			std::swap(greater, smaller);
+		result.limbs.resize(greater->size() + 1);
+		result.limbs.back() = AddLimbs(result.limbs.data(), greater->data(), greater->size(), smaller->data(), smaller->size());
+		result.negative = x.negative;
+	}
+	else {
+		// Subtracting the smaller absolute value from the greater, and taking the sign of the greater
+		result.negative = x.negative;
+		if (CompareLimbs(greater->data(), greater->size(), smaller->data(), smaller->size()) < 0) {
+			std::swap(greater, smaller);
+			result.negative = yNegative;
+		}
+		result.limbs.resize(greater->size());
+		SubtractLimbs(result.limbs.data(), greater->data(), greater->size(), smaller->data(), smaller->size());
+	}
+	TrimLimbs(result.limbs);
+	if (result.limbs.size() == 1 && result.limbs[0] == 0)
+		result.negative = false;
+	return result;
+}
+
+static SignedLimbs SignedMultiply(const SignedLimbs& x, const SignedLimbs& y)
+{
+	SignedLimbs result;
+	result.limbs.resize(x.limbs.size() + y.limbs.size());
+	MultiplyLimbs(x.limbs.data(), x.limbs.size(), y.limbs.data(), y.limbs.size(), result.limbs.data()); // squares if (&x == &y)
+	TrimLimbs(result.limbs);
+	result.negative = (x.negative != y.negative) && !(result.limbs.size() == 1 && result.limbs[0] == 0);
+	return result;
+}
+
+// Multiplies the absolute value by 2^1 (shift = 1) or divides it by 2^1 (shift = -1)
+static void SignedShiftByOne(SignedLimbs& x, int shift)
+{
+	std::vector<unsigned long long>& limbs = x.limbs;
+	if (shift > 0) {
+		limbs.push_back(0);
+		for (unsigned int i = limbs.size() - 1; i > 0; i--)
+			limbs[i] = (limbs[i] << 1) | (limbs[i - 1] >> 63);
+		limbs[0] <<= 1;
+	}
+	else {
+		for (unsigned int i = 0; i + 1 < limbs.size(); i++)
+			limbs[i] = (limbs[i] >> 1) | (limbs[i + 1] << 63);
+		limbs.back() >>= 1;
+	}
+	TrimLimbs(limbs);
+}
+
+// Divides the absolute value by 3, where the division is known to be exact
+static void SignedDivideByThree(SignedLimbs& x)
+{
+	// Dividing every 32-bit half (from the most significant) so that the partial dividend always fits in 64 bits
+	unsigned long long remainder = 0;
+	for (unsigned int i = x.limbs.size(); i-- > 0; ) {
+		unsigned long long high = (remainder << 32) | (x.limbs[i] >> 32);
+		remainder = high % 3;
+		unsigned long long low = (remainder << 32) | (x.limbs[i] & LOW_DWORD);
+		remainder = low % 3;
+		x.limbs[i] = ((high / 3) << 32) | (low / 3);
+	}
+	TrimLimbs(x.limbs);
+}
+
+/*	Toom-Cook 3-way multiplication: result[0 .. 2*size) = a * b, where both a and b have (size) limbs.
+*	Each number is split into 3 parts of (partSize) limbs: a = a2 * X^2 + a1 * X + a0, where X = 2^(64*partSize)
+*	Both are treated as polynomials of X, which are evaluated at the points (0, 1, -1, -2, infinity),
+*	multiplied at these points (5 multiplications of a third of the size instead of 9),
+*	and the product polynomial r(X) = r4 * X^4 + r3 * X^3 + r2 * X^2 + r1 * X + r0 is interpolated back
+*	using Bodrato's sequence. Lastly, the product is evaluated at X = 2^(64*partSize) to get the result.
+*/
+static void MultiplyToom3(const unsigned long long* a, const unsigned long long* b, unsigned int size,
+	unsigned long long* result)
+{
+	unsigned int partSize = (size + 2) / 3, lastSize = size - 2 * partSize;
+	const unsigned long long* inputs[2] = { a, b };
+	SignedLimbs atZero[2], atOne[2], atMinusOne[2], atMinusTwo[2], atInfinity[2];
+
+	// For squaring (a == b), the input is only evaluated once, and the 5 products are squares
+	unsigned int inputCount = a == b ? 1 : 2, last = inputCount - 1;
+	for (unsigned int i = 0; i < inputCount; i++) {
+		SignedLimbs part0 = ToSignedLimbs(inputs[i], partSize);
+		SignedLimbs part1 = ToSignedLimbs(inputs[i] + partSize, partSize);
+		SignedLimbs part2 = ToSignedLimbs(inputs[i] + 2 * partSize, lastSize);
+
+		SignedLimbs evenParts = SignedAdd(part0, part2);
+		atZero[i] = part0;
+		atOne[i] = SignedAdd(evenParts, part1);
+		atMinusOne[i] = SignedAdd(evenParts, part1, true);
+		atMinusTwo[i] = SignedAdd(atMinusOne[i], part2);	// (p(-1) + a2) * 2 - a0 = a0 - 2*a1 + 4*a2
+		SignedShiftByOne(atMinusTwo[i], 1);
+		atMinusTwo[i] = SignedAdd(atMinusTwo[i], part0, true);
+		atInfinity[i] = part2;
+	}
+
+	// The 5 products are independent, so they can run on different threads
+	SignedLimbs r0, r1, r2, r3, r4; // r2 = r(-1) and r3 = r(-2) at first
+	SignedLimbs* products[5] = { &r0, &r1, &r2, &r3, &r4 };
+	const SignedLimbs* points[5] = { atZero, atOne, atMinusOne, atMinusTwo, atInfinity };
+	auto multiplyAtPoint = [&](unsigned int i) { *products[i] = SignedMultiply(points[i][0], points[i][last]); };
+	threadPool* pool = ParallelPoolFor(size);
+	if (pool != nullptr)
+		pool->ForEach(5, multiplyAtPoint);
+	else
+		for (unsigned int i = 0; i < 5; i++)
+			multiplyAtPoint(i);
+
+	// Interpolation (every division here is exact):
+	r3 = SignedAdd(r3, r1, true);		// r3 = (r(-2) - r(1)) / 3
+	SignedDivideByThree(r3);
+	SignedLimbs minusOne = r2;
+	r1 = SignedAdd(r1, minusOne, true);	// r1 = (r(1) - r(-1)) / 2
+	SignedShiftByOne(r1, -1);
+	r2 = SignedAdd(minusOne, r0, true);	// r2 = r(-1) - r(0)
+	r3 = SignedAdd(r2, r3, true);		// r3 = (r2 - r3) / 2 + 2 * r(inf)
+	SignedShiftByOne(r3, -1);
+	SignedLimbs twiceR4 = r4;
+	SignedShiftByOne(twiceR4, 1);
+	r3 = SignedAdd(r3, twiceR4);
+	r2 = SignedAdd(r2, r1);				// r2 = r2 + r1 - r(inf)
+	r2 = SignedAdd(r2, r4, true);
+	r1 = SignedAdd(r1, r3, true);		// r1 = r1 - r3
+
+	// All the coefficients are non-negative now, add each of them in its place
+	std::fill(result, result + 2 * size, 0ULL);
+	const SignedLimbs* coefficients[5] = { &r0, &r1, &r2, &r3, &r4 };
+	for (unsigned int i = 0; i < 5; i++) {
+		unsigned int offset = i * partSize, restSize = 2 * size - offset;
+		const std::vector<unsigned long long>& limbs = coefficients[i]->limbs;
+		AddLimbs(result + offset, result + offset, restSize, limbs.data(), std::min((unsigned int)limbs.size(), restSize));
+	}
+}
+
+// The 3 primes of the number-theoretic transforms, each one is of the form (c * 2^k + 1) and between 2^62 and 2^63.
+// Their product is about 2^189, which is enough for the coefficients of the product of two numbers up to ABSOLUTE_MAX_SIZE,
+// since each coefficient is a sum of (up to 2^27) products of two 64-bit limbs (less than 2^155).
+struct NttPrime
+{
+	unsigned long long modulus;
+	unsigned int maxLogLength;			// k (the transform length can be up to 2^k)
+	unsigned long long generator;		// a primitive root modulo (modulus)
+	unsigned long long inverse;			// -modulus^-1 mod 2^64 (for the Montgomery reduction)
+	unsigned long long rSquared;		// 2^128 mod modulus (to convert numbers into the Montgomery form)
+};
+
+// Montgomery multiplication modulo a 63-bit prime: returns (a * b / 2^64) mod modulus, where a, b < modulus
+static inline unsigned long long MontgomeryMultiply64(unsigned long long a, unsigned long long b, const NttPrime& prime)
+{
+	unsigned long long high, low = MultiplyWide(a, b, high);
+	unsigned long long reductionHigh;
+	MultiplyWide(low * prime.inverse, prime.modulus, reductionHigh);
+	// The lower 64 bits of (low + reduction) are zeros, and there is a carry only if low is not zero
+	unsigned long long result = high + reductionHigh + (low != 0);
+	return result >= prime.modulus ? result - prime.modulus : result;
+}
+
+static inline unsigned long long AddModular64(unsigned long long a, unsigned long long b, unsigned long long modulus)
+{
+	unsigned long long result = a + b; // no overflow, since the modulus is less than 2^63
+	return result >= modulus ? result - modulus : result;
+}
+
+static inline unsigned long long SubtractModular64(unsigned long long a, unsigned long long b, unsigned long long modulus)
+{
+	return a >= b ? a - b : a + modulus - b;
+}
+
+// Returns (base^exponent) in the Montgomery form, where base is in the Montgomery form too
+static unsigned long long PowerModular64(unsigned long long base, unsigned long long exponent, const NttPrime& prime)
+{
+	unsigned long long result = MontgomeryMultiply64(1, prime.rSquared, prime);
+	while (exponent > 0) {
+		if (exponent & 1)
+			result = MontgomeryMultiply64(result, base, prime);
+		base = MontgomeryMultiply64(base, base, prime);
+		exponent >>= 1;
+	}
+	return result;
+}
+
+static NttPrime MakeNttPrime(unsigned long long modulus, unsigned int maxLogLength, unsigned long long generator)
+{
+	NttPrime prime = { modulus, maxLogLength, generator, 0, 0 };
+
+	prime.inverse = NegativeInverseOfLimb(modulus);
+
+	// 2^128 mod modulus by doubling (2^64 mod modulus) 64 times
+	unsigned long long rSquared = (0 - modulus) % modulus;
+	for (unsigned int i = 0; i < 64; i++)
+		rSquared = AddModular64(rSquared, rSquared, modulus);
+	prime.rSquared = rSquared;
+	return prime;
+}
+
+// All the constants needed by MultiplyNtt, which are computed once on the first use
+struct NttConstants
+{
+	NttPrime primes[3];
+	unsigned long long firstInverse;		// modulus[0]^-1 mod modulus[1] (Montgomery form)
+	unsigned long long firstModThird;		// modulus[0] mod modulus[2] (Montgomery form)
+	unsigned long long productInverse;		// (modulus[0] * modulus[1])^-1 mod modulus[2] (Montgomery form)
+	unsigned long long product[2];			// modulus[0] * modulus[1] (128-bit)
+
+	NttConstants()
+	{
+		primes[0] = MakeNttPrime(0x7FFFEF0000000001ULL, 40, 5);
+		primes[1] = MakeNttPrime(0x7FFFE90000000001ULL, 40, 7);
+		primes[2] = MakeNttPrime(0x7FFFF74000000001ULL, 38, 17);
+
+		// Inverses by Fermat's little theorem: x^-1 = x^(p-2) mod p
+		const NttPrime& second = primes[1];
+		const NttPrime& third = primes[2];
+		firstInverse = PowerModular64(MontgomeryMultiply64(primes[0].modulus % second.modulus, second.rSquared, second),
+			second.modulus - 2, second);
+		firstModThird = MontgomeryMultiply64(primes[0].modulus % third.modulus, third.rSquared, third);
+		product[0] = MultiplyWide(primes[0].modulus, primes[1].modulus, product[1]);
+		unsigned long long productModThird = MontgomeryMultiply64(firstModThird,
+			MontgomeryMultiply64(primes[1].modulus % third.modulus, third.rSquared, third), third); // still in Montgomery form
+		productInverse = PowerModular64(productModThird, third.modulus - 2, third);
+	}
+};
+
+static const NttConstants& GetNttConstants()
+{
+	static const NttConstants constants;
+	return constants;
+}
+
+/*	Twiddle factors of all the stages of a transform of length 2^logLength (in the Montgomery form):
+*	The stage that combines blocks of (half) elements uses table[half .. 2*half), where table[half + j] = w^j,
+*	and w is a primitive (2*half)-th root of unity. So the whole table has (2^logLength) elements.
+*	Each stage's factors are every other factor of the next stage, since w^2 is a primitive (half)-th root of unity.
+*	With a thread pool, each range of the last stage's factors starts from its own power of w.
+*/
+static void NttTwiddleFactors(std::vector<unsigned long long>& table, unsigned int logLength, const NttPrime& prime, bool inverse,
+	threadPool* pool = nullptr)
+{
+	unsigned int length = 1U << logLength, half = length >> 1;
+	table.resize(length);
+	unsigned long long generator = MontgomeryMultiply64(prime.generator, prime.rSquared, prime);
+	unsigned long long root = PowerModular64(generator, (prime.modulus - 1) >> logLength, prime);
+	if (inverse)
+		root = PowerModular64(root, length - 1, prime);
+
+	ParallelRanges(pool, half, NTT_PARALLEL_RANGE, [&](unsigned int begin, unsigned int end) {
+		table[half + begin] = begin == 0 ? MontgomeryMultiply64(1, prime.rSquared, prime) : PowerModular64(root, begin, prime);
+		for (unsigned int j = begin + 1; j < end; j++)
+			table[half + j] = MontgomeryMultiply64(table[half + j - 1], root, prime);
+	});
+	for (unsigned int stage = half >> 1; stage > 0; stage >>= 1)
+		for (unsigned int j = 0; j < stage; j++)
+			table[stage + j] = table[2 * (stage + j)];
+}
+
+// The butterflies j = begin .. end-1 of the forward transform's stage that combines the two halves of a block of (2*half) elements
+static inline void NttForwardButterflies(unsigned long long* block, unsigned int half, unsigned int begin, unsigned int end,
+	const std::vector<unsigned long long>& twiddles, const NttPrime& prime)
+{
+	for (unsigned int j = begin; j < end; j++) {
+		unsigned long long u = block[j], v = block[j + half];
+		block[j] = AddModular64(u, v, prime.modulus);
+		block[j + half] = MontgomeryMultiply64(SubtractModular64(u, v, prime.modulus), twiddles[half + j], prime);
+	}
+}
+
+static inline void NttInverseButterflies(unsigned long long* block, unsigned int half, unsigned int begin, unsigned int end,
+	const std::vector<unsigned long long>& twiddles, const NttPrime& prime)
+{
+	for (unsigned int j = begin; j < end; j++) {
+		unsigned long long u = block[j];
+		unsigned long long v = MontgomeryMultiply64(block[j + half], twiddles[half + j], prime);
+		block[j] = AddModular64(u, v, prime.modulus);
+		block[j + half] = SubtractModular64(u, v, prime.modulus);
+	}
+}
+
+// Forward transform (decimation in frequency): the input is in natural order, and the output is in bit-reversed order.
+// With a thread pool, the first stage is split into ranges, then the two halves are independent transforms of half the length.
+static void NttForward(unsigned long long* values, unsigned int length, const std::vector<unsigned long long>& twiddles,
+	const NttPrime& prime, threadPool* pool = nullptr)
+{
+	if (pool != nullptr && length > NTT_PARALLEL_RANGE) {
+		unsigned int half = length >> 1;
+		ParallelRanges(pool, half, NTT_PARALLEL_RANGE, [&](unsigned int begin, unsigned int end) {
+			NttForwardButterflies(values, half, begin, end, twiddles, prime);
+		});
+		pool->ForEach(2, [&](unsigned int i) { NttForward(values + i * half, half, twiddles, prime, pool); });
+		return;
+	}
+
+	for (unsigned int half = length >> 1; half > 0; half >>= 1)
+		for (unsigned int start = 0; start < length; start += 2 * half)
+			NttForwardButterflies(values + start, half, 0, half, twiddles, prime);
+}
+
+// Inverse transform (decimation in time, without the division by the length):
+// the input is in bit-reversed order, and the output is in natural order.
+// With a thread pool, the two halves are transformed independently first, then the last stage is split into ranges.
+static void NttInverse(unsigned long long* values, unsigned int length, const std::vector<unsigned long long>& twiddles,
+	const NttPrime& prime, threadPool* pool = nullptr)
+{
+	if (pool != nullptr && length > NTT_PARALLEL_RANGE) {
+		unsigned int half = length >> 1;
+		pool->ForEach(2, [&](unsigned int i) { NttInverse(values + i * half, half, twiddles, prime, pool); });
+		ParallelRanges(pool, half, NTT_PARALLEL_RANGE, [&](unsigned int begin, unsigned int end) {
+			NttInverseButterflies(values, half, begin, end, twiddles, prime);
+		});
+		return;
+	}
+
+	for (unsigned int half = 1; half < length; half <<= 1)
+		for (unsigned int start = 0; start < length; start += 2 * half)
+			NttInverseButterflies(values + start, half, 0, half, twiddles, prime);
+}
+
+/*	Multiplication by number-theoretic transforms: result[0 .. aSize + bSize) = a * b
+*	Each limb is treated as a coefficient of a polynomial of X = 2^64, and the product polynomial is computed modulo
+*	each of the 3 primes by a cyclic convolution: forward transforms, pointwise multiplication and an inverse transform.
+*	Then the exact coefficients are recovered from the 3 residues by the Chinese remainder theorem (Garner's method),
+*	and added in their places in the result (each coefficient is up to 3 limbs, so the carries are added along).
+*	This is done in O(N log N) instead of O(N^1.465) of Toom-3.
+*	With a thread pool (see ParallelPoolFor), the 3 primes run on different threads, and each of their transforms and loops
+*	is split further. The coefficients are added in ranges, each with its own carry, and the carries are added at the end.
+*/
+static void MultiplyNtt(const unsigned long long* a, unsigned int aSize, const unsigned long long* b, unsigned int bSize,
+	unsigned long long* result)
+{
+	const NttConstants& constants = GetNttConstants();
+	unsigned int logLength = 0;
+	while ((1ULL << logLength) < (unsigned long long)aSize + bSize - 1)
+		logLength++;
+	unsigned int length = 1U << logLength;
+	threadPool* pool = ParallelPoolFor(std::min(aSize, bSize));
+
+	// For squaring (the same input twice), only one forward transform is needed for each prime
+	bool square = a == b && aSize == bSize;
+	std::vector<unsigned long long> residues[3];
+	auto convolveModPrime = [&](unsigned int p) {
+		const NttPrime& prime = constants.primes[p];
+		std::vector<unsigned long long>& values = residues[p];
+		std::vector<unsigned long long> otherValues(square ? 0 : length), twiddles;
+		values.resize(length);
+		ParallelRanges(pool, length, NTT_PARALLEL_RANGE, [&](unsigned int begin, unsigned int end) {
+			for (unsigned int i = begin; i < end; i++)
+				values[i] = i < aSize ? a[i] % prime.modulus : 0;
+			if (!square)
+				for (unsigned int i = begin; i < end; i++)
+					otherValues[i] = i < bSize ? b[i] % prime.modulus : 0;
+		});
+		NttTwiddleFactors(twiddles, logLength, prime, false, pool);
+		NttForward(values.data(), length, twiddles, prime, pool);
+
+		const unsigned long long* transformB = values.data();
+		if (!square) {
+			NttForward(otherValues.data(), length, twiddles, prime, pool);
+			transformB = otherValues.data();
+		}
+
+		// The Montgomery multiplication divides by 2^64, so the scale (length^-1) is multiplied by 2^128 to make up for the two of them.
+		// length^-1 = -(modulus - 1) / length (mod modulus), since length divides (modulus - 1).
+		unsigned long long scale = prime.modulus - ((prime.modulus - 1) >> logLength);
+		scale = MontgomeryMultiply64(MontgomeryMultiply64(scale, prime.rSquared, prime), prime.rSquared, prime);
+		ParallelRanges(pool, length, NTT_PARALLEL_RANGE, [&](unsigned int begin, unsigned int end) {
+			for (unsigned int i = begin; i < end; i++)
+				values[i] = MontgomeryMultiply64(MontgomeryMultiply64(values[i], transformB[i], prime), scale, prime);
+		});
+
+		NttTwiddleFactors(twiddles, logLength, prime, true, pool);
+		NttInverse(values.data(), length, twiddles, prime, pool);
+	};
+	if (pool != nullptr)
+		pool->ForEach(3, convolveModPrime);
+	else
+		for (unsigned int p = 0; p < 3; p++)
+			convolveModPrime(p);
+
+	// Garner's method: coefficient = v1 + v2 * p1 + v3 * p1 * p2, where v1 < p1, v2 < p2, v3 < p3
+	const NttPrime& second = constants.primes[1];
+	const NttPrime& third = constants.primes[2];
+	unsigned int resultSize = aSize + bSize;
+	std::vector<unsigned long long> rangeCarries;
+	std::vector<unsigned int> rangeEnds;
+	std::mutex carriesMutex;
+	ParallelRanges(pool, resultSize, NTT_PARALLEL_RANGE, [&](unsigned int begin, unsigned int end) {
+		unsigned long long carry[3] = { 0, 0, 0 };
+		for (unsigned int i = begin; i < end; i++) {
+			unsigned long long v1 = 0, v2 = 0, v3 = 0;
+			if (i < length) {
+				v1 = residues[0][i];
+				v2 = MontgomeryMultiply64(SubtractModular64(residues[1][i], v1 % second.modulus, second.modulus),
+					constants.firstInverse, second);
+				unsigned long long partial = AddModular64(v1 % third.modulus,
+					MontgomeryMultiply64(v2, constants.firstModThird, third), third.modulus); // (v1 + v2 * p1) mod p3
+				v3 = MontgomeryMultiply64(SubtractModular64(residues[2][i], partial, third.modulus), constants.productInverse, third);
+			}
+
+			// coefficient = (v2 * p1 + v1) + v3 * (p1 * p2), as 3 limbs
+			unsigned long long coefficient[3], partial[3], high;
+			coefficient[0] = MultiplyWide(v2, constants.primes[0].modulus, coefficient[1]);
+			coefficient[0] += v1;
+			coefficient[1] += coefficient[0] < v1;
+			coefficient[2] = 0;
+			partial[0] = MultiplyWide(v3, constants.product[0], partial[1]);
+			unsigned long long low = MultiplyWide(v3, constants.product[1], high);
+			partial[1] += low;
+			partial[2] = high + (partial[1] < low); // the product is less than 2^189, so it does not overflow
+			AddLimbs(coefficient, coefficient, 3, partial, 3);
+
+			// Adding the coefficient to the carry of the previous ones, and moving out the lowest limb
+			AddLimbs(carry, carry, 3, coefficient, 3);
+			result[i] = carry[0];
+			carry[0] = carry[1];
+			carry[1] = carry[2];
+			carry[2] = 0;
+		}
+
+		// The carry out of a range belongs to the limbs after it (none is left after the last range)
+		if (end < resultSize) {
+			std::lock_guard<std::mutex> lock(carriesMutex);
+			rangeCarries.insert(rangeCarries.end(), carry, carry + 3);
+			rangeEnds.push_back(end);
+		}
+	});
+	for (unsigned int k = 0; k < rangeEnds.size(); k++) {
+		unsigned int end = rangeEnds[k], restSize = resultSize - end;
+		AddLimbs(result + end, result + end, restSize, &rangeCarries[3 * k], std::min(restSize, 3U));
+	}
+}
+
+// result[0 .. 2*size) = a * b, where both a and b have (size) limbs. This selects the algorithm by the size.
+static void MultiplyBalanced(const unsigned long long* a, const unsigned long long* b, unsigned int size,
+	unsigned long long* result, unsigned long long* scratch)
+{
+	if (size < KARATSUBA_THRESHOLD)
+		MultiplyBasecase(a, size, b, size, result);
+	else if (size < TOOM3_THRESHOLD)
+		MultiplyKaratsuba(a, b, size, result, scratch);
+	else
+		MultiplyToom3(a, b, size, result);
+}
+
+static void SquareBalanced(const unsigned long long* a, unsigned int size, unsigned long long* result, unsigned long long* scratch)
+{
+	if (size < KARATSUBA_THRESHOLD)
+		SquareBasecase(a, size, result);
+	else if (size < TOOM3_THRESHOLD)
+		SquareKaratsuba(a, size, result, scratch);
+	else
+		MultiplyToom3(a, a, size, result);
+}
+
+// result[0 .. aSize + bSize) = a * b, for any sizes (this is the entry point for all multiplications)
+static void MultiplyLimbs(const unsigned long long* a, unsigned int aSize, const unsigned long long* b, unsigned int bSize,
+	unsigned long long* result)
+{
+	if (a == b && aSize == bSize) {
+		SquareLimbs(a, aSize, result);
+		return;
+	}
+
+	if (aSize < bSize) {
+		std::swap(a, b);
+		std::swap(aSize, bSize);
+	}
+
+	if (bSize < KARATSUBA_THRESHOLD) {
+		MultiplyBasecase(a, aSize, b, bSize, result);
+		return;
+	}
+
+	if (bSize >= NTT_THRESHOLD) {
+		MultiplyNtt(a, aSize, b, bSize, result);
+		return;
+	}
+
+	std::vector<unsigned long long> scratch(KaratsubaScratchSize(bSize));
+	if (aSize == bSize) {
+		MultiplyBalanced(a, b, bSize, result, scratch.data());
+		return;
+	}
+
+	// Unbalanced sizes: multiply b by every (bSize)-limb chunk of a, and add each product in its place
+	std::vector<unsigned long long> product(2 * bSize);
+	std::fill(result, result + aSize + bSize, 0ULL);
+	for (unsigned int offset = 0; offset < aSize; offset += bSize) {
+		unsigned int chunkSize = std::min(bSize, aSize - offset);
+		if (chunkSize == bSize)
+			MultiplyBalanced(a + offset, b, bSize, product.data(), scratch.data());
+		else
+			MultiplyLimbs(a + offset, chunkSize, b, bSize, product.data());
+		unsigned int restSize = aSize + bSize - offset;
+		AddLimbs(result + offset, result + offset, restSize, product.data(), chunkSize + bSize);
+	}
+}
+
+// result[0 .. 2*size) = a * a, with the same selection of the algorithm as MultiplyLimbs (MultiplyLimbs calls it for the same input twice)
+static void SquareLimbs(const unsigned long long* a, unsigned int size, unsigned long long* result)
+{
+	if (size < KARATSUBA_THRESHOLD) {
+		SquareBasecase(a, size, result);
+		return;
+	}
+
+	if (size >= NTT_THRESHOLD) {
+		MultiplyNtt(a, size, a, size, result);
+		return;
+	}
+
+	std::vector<unsigned long long> scratch(KaratsubaScratchSize(size));
+	SquareBalanced(a, size, result, scratch.data());
+}
+
+// quotient[0 .. size) = a / divisor, and returns the remainder. quotient may be the same array as a.
+// The divisor is normalized once (and a is shifted on the fly), so the whole pass is linear and uses its precomputed reciprocal.
+static unsigned long long DivideLimbsBySingle(unsigned long long* quotient, const unsigned long long* a, unsigned int size,
+	unsigned long long divisor)
+{
+	unsigned int shift = CountLeadingZeros(divisor);
+	divisor <<= shift;
+	unsigned long long reciprocal = ReciprocalOfLimb(divisor);
+
+	// The remainder is kept shifted by (shift) bits, and starts with the bits shifted out of the top limb
+	unsigned long long remainder = shift == 0 ? 0 : a[size - 1] >> (64 - shift);
+	for (unsigned int i = size; i-- > 0; ) {
+		unsigned long long limb = a[i] << shift;
+		if (shift != 0 && i > 0)
+			limb |= a[i - 1] >> (64 - shift);
+		quotient[i] = DivideWideByReciprocal(remainder, limb, divisor, reciprocal, remainder);
+	}
+	return remainder >> shift;
+}
+
+/*	Knuth's Algorithm D (The Art of Computer Programming, Vol. 2, 4.3.1) on 64-bit limbs:
+*	quotient[0 .. uSize - vSize + 1) = u / v, remainder[0 .. vSize) = u % v, where (uSize >= vSize >= 2) and the top limb of v is not zero.
+*	
+*	Both numbers are shifted to the left until the highest bit of v is 1 (normalization), then each quotient limb is estimated
+*	from the top 2 limbs of the current partial remainder divided by the top limb of v (a 128-bit by 64-bit division).
+*	The estimate is corrected by the second limb of v, after which it is at most 1 more than the actual limb,
+*	and this rare case is detected by a borrow out of the multiply-and-subtract step and fixed by adding v back.
+*	This needs O(vSize * (uSize - vSize)) limb operations, and allocates only the normalized copies of u and v.
+*/
+static void DivideLimbs(const unsigned long long* u, unsigned int uSize, const unsigned long long* v, unsigned int vSize,
+	unsigned long long* quotient, unsigned long long* remainder)
+{
+	unsigned int shift = CountLeadingZeros(v[vSize - 1]);
+	std::vector<unsigned long long> normalizedV(vSize), normalizedU(uSize + 1);
+	for (unsigned int i = vSize - 1; i > 0; i--)
+		normalizedV[i] = shift == 0 ? v[i] : (v[i] << shift) | (v[i - 1] >> (64 - shift));
+	normalizedV[0] = v[0] << shift;
+	normalizedU[uSize] = shift == 0 ? 0 : u[uSize - 1] >> (64 - shift);
+	for (unsigned int i = uSize - 1; i > 0; i--)
+		normalizedU[i] = shift == 0 ? u[i] : (u[i] << shift) | (u[i - 1] >> (64 - shift));
+	normalizedU[0] = u[0] << shift;
+
+	unsigned long long* un = normalizedU.data();
+	const unsigned long long* vn = normalizedV.data();
+	unsigned long long vTop = vn[vSize - 1], vSecond = vn[vSize - 2];
+
+	for (unsigned int j = uSize - vSize + 1; j-- > 0; ) {
+		// Estimate the quotient limb from (un[j + vSize] : un[j + vSize - 1]) / vTop, where un[j + vSize] <= vTop
+		unsigned long long estimate, partialRemainder;
+		bool remainderOverflow = false;
+		if (un[j + vSize] >= vTop) {
+			estimate = ~0ULL;
+			partialRemainder = un[j + vSize - 1] + vTop;
+			remainderOverflow = partialRemainder < vTop;
+		}
+		else
+			estimate = DivideWide(un[j + vSize], un[j + vSize - 1], vTop, partialRemainder);
+
+		// Correct the estimate while (estimate * vSecond) > (partialRemainder : un[j + vSize - 2])
+		while (!remainderOverflow) {
+			unsigned long long productHigh, productLow = MultiplyWide(estimate, vSecond, productHigh);
+			if (productHigh < partialRemainder || (productHigh == partialRemainder && productLow <= un[j + vSize - 2]))
+				break;
+			estimate--;
+			partialRemainder += vTop;
+			remainderOverflow = partialRemainder < vTop;
+		}
+
+		// Multiply and subtract, then add back if the estimate was still 1 more than the actual limb
+		unsigned long long borrow = MultiplySubtractRow(un + j, vn, vSize, estimate);
+		unsigned long long top = un[j + vSize];
+		un[j + vSize] = top - borrow;
+		if (top < borrow) {
+			estimate--;
+			un[j + vSize] += AddLimbs(un + j, un + j, vSize, vn, vSize);
+		}
+		quotient[j] = estimate;
+	}
+
+	// Unnormalize the remainder
+	for (unsigned int i = 0; i < vSize; i++)
+		remainder[i] = shift == 0 ? un[i] : (un[i] >> shift) | (un[i + 1] << (64 - shift));
+}
+
+// The following helpers work on numbers held in whole vectors (trimmed, with at least 1 element) for the recursive division algorithms
+
+// Returns x[from .. from + count) (the missing limbs are zeros)
+static std::vector<unsigned long long> SliceLimbs(const std::vector<unsigned long long>& x, unsigned int from, unsigned int count)
+{
+	std::vector<unsigned long long> result(std::max(count, 1U), 0);
+	for (unsigned int i = 0; i < count && from + i < x.size(); i++)
+		result[i] = x[from + i];
+	TrimLimbs(result);
+	return result;
+}
+
+// x += y * 2^(64*offset)
+static void AddLimbsTo(std::vector<unsigned long long>& x, const std::vector<unsigned long long>& y, unsigned int offset = 0)
+{
+	if (x.size() < y.size() + offset)
+		x.resize(y.size() + offset, 0);
+	unsigned long long carry = AddLimbs(x.data() + offset, x.data() + offset, x.size() - offset, y.data(), y.size());
+	if (carry)
+		x.push_back(carry);
+}
+
+// x -= y, where x >= y
+static void SubtractLimbsFrom(std::vector<unsigned long long>& x, const std::vector<unsigned long long>& y)
+{
+	SubtractLimbs(x.data(), x.data(), x.size(), y.data(), y.size());
+	TrimLimbs(x);
+}
+
+static std::vector<unsigned long long> MultiplyLimbVectors(const std::vector<unsigned long long>& a, const std::vector<unsigned long long>& b)
+{
+	std::vector<unsigned long long> result(a.size() + b.size());
+	MultiplyLimbs(a.data(), a.size(), b.data(), b.size(), result.data());
+	TrimLimbs(result);
+	return result;
+}
+
+static unsigned long long BitLengthOfLimbs(const std::vector<unsigned long long>& x)
+{
+	return 64ULL * x.size() - CountLeadingZeros(x.back());
+}
+
+static std::vector<unsigned long long> ShiftLimbsLeft(const std::vector<unsigned long long>& x, unsigned long long bits)
+{
+	unsigned int shiftElements = bits >> 6, shiftBits = bits & 63;
+	std::vector<unsigned long long> result(x.size() + shiftElements + 1, 0);
+	for (unsigned int i = 0; i < x.size(); i++) {
+		result[i + shiftElements] |= x[i] << shiftBits;
+		if (shiftBits > 0)
+			result[i + shiftElements + 1] = x[i] >> (64 - shiftBits);
+	}
+	TrimLimbs(result);
+	return result;
+}
+
+static std::vector<unsigned long long> ShiftLimbsRight(const std::vector<unsigned long long>& x, unsigned long long bits)
+{
+	unsigned int shiftElements = bits >> 6, shiftBits = bits & 63;
+	if (shiftElements >= x.size())
+		return std::vector<unsigned long long>(1, 0);
+	std::vector<unsigned long long> result(x.size() - shiftElements);
+	for (unsigned int i = 0; i < result.size(); i++) {
+		result[i] = x[i + shiftElements] >> shiftBits;
+		if (shiftBits > 0 && i + shiftElements + 1 < x.size())
+			result[i] |= x[i + shiftElements + 1] << (64 - shiftBits);
+	}
+	TrimLimbs(result);
+	return result;
+}
+
+static void DivideLimbVectors(const std::vector<unsigned long long>& u, const std::vector<unsigned long long>& v,
+	std::vector<unsigned long long>& quotient, std::vector<unsigned long long>& remainder);
+
+// The base case of the recursive algorithms: quotient = u / v, remainder = u % v by Knuth's Algorithm D (or a single-limb division)
+static void DivideLimbVectorsBasecase(const std::vector<unsigned long long>& u, const std::vector<unsigned long long>& v,
+	std::vector<unsigned long long>& quotient, std::vector<unsigned long long>& remainder)
+{
+	if (CompareLimbs(u.data(), u.size(), v.data(), v.size()) < 0) {
+		quotient.assign(1, 0);
+		remainder = u;
+		return;
+	}
+	quotient.assign(u.size() - v.size() + 1, 0);
+	remainder.assign(v.size(), 0);
+	if (v.size() == 1)
+		remainder[0] = DivideLimbsBySingle(quotient.data(), u.data(), u.size(), v[0]);
+	else
+		DivideLimbs(u.data(), u.size(), v.data(), v.size(), quotient.data(), remainder.data());
+	TrimLimbs(quotient);
+	TrimLimbs(remainder);
+}
+
+static void DivideThreeHalvesByTwo(const std::vector<unsigned long long>& a, const std::vector<unsigned long long>& b, unsigned int size,
+	std::vector<unsigned long long>& quotient, std::vector<unsigned long long>& remainder);
+
+/*	Burnikel-Ziegler recursive division ("Fast Recursive Division", 1998):
+*	quotient = a / b, remainder = a % b, where b has exactly (size) limbs with its highest bit set, and a < b * 2^(64*size).
+*	Both a and b are split into halves of (size/2) limbs, and the division is done by two divisions of 3 halves by 2 halves,
+*	each of which is a recursive division of 2 halves by 1 half followed by a multiplication to correct it.
+*	So the division costs about 2 multiplications of (size) limbs, each done by the fast multiplication algorithms.
+*/
+static void DivideTwoByOne(const std::vector<unsigned long long>& a, const std::vector<unsigned long long>& b, unsigned int size,
+	std::vector<unsigned long long>& quotient, std::vector<unsigned long long>& remainder)
+{
+	if ((size & 1) || size < BURNIKEL_ZIEGLER_THRESHOLD) {
+		DivideLimbVectorsBasecase(a, b, quotient, remainder);
+		return;
+	}
+
+	unsigned int half = size >> 1;
+	std::vector<unsigned long long> highQuotient, partialRemainder;
+	DivideThreeHalvesByTwo(SliceLimbs(a, half, 3 * half), b, size, highQuotient, partialRemainder);
+
+	std::vector<unsigned long long> lowPart = SliceLimbs(a, 0, half);
+	AddLimbsTo(lowPart, partialRemainder, half);
+	DivideThreeHalvesByTwo(lowPart, b, size, quotient, remainder);
+	AddLimbsTo(quotient, highQuotient, half);
+}
+
+// quotient = a / b, remainder = a % b, where a has 3 halves and b has 2 halves (of size/2 limbs each), and a < b * 2^(64*size/2)
+static void DivideThreeHalvesByTwo(const std::vector<unsigned long long>& a, const std::vector<unsigned long long>& b, unsigned int size,
+	std::vector<unsigned long long>& quotient, std::vector<unsigned long long>& remainder)
+{
+	unsigned int half = size >> 1;
+	std::vector<unsigned long long> highB = SliceLimbs(b, half, half), lowB = SliceLimbs(b, 0, half);
+	std::vector<unsigned long long> highA = SliceLimbs(a, half, 2 * half), topA = SliceLimbs(a, 2 * half, half);
+
+	// Estimate the quotient by the higher halves: (a1 * X + a2) / b1, where X = 2^(64*half)
+	if (CompareLimbs(topA.data(), topA.size(), highB.data(), highB.size()) < 0)
+		DivideTwoByOne(highA, highB, half, quotient, remainder);
+	else {
+		// The estimate is (X - 1), and the remainder is (a1 * X + a2) - (X - 1) * b1 = (a1 * X + a2) - b1 * X + b1
+		quotient.assign(half, ~0ULL);
+		remainder = highA;
+		AddLimbsTo(remainder, highB);
+		std::vector<unsigned long long> shiftedB(half, 0);
+		shiftedB.insert(shiftedB.end(), highB.begin(), highB.end());
+		SubtractLimbsFrom(remainder, shiftedB);
+	}
+
+	// Correct the estimate: remainder = remainder * X + a3 - quotient * b2, and add b back while it is negative (at most twice)
+	std::vector<unsigned long long> product = MultiplyLimbVectors(quotient, lowB);
+	std::vector<unsigned long long> fullRemainder = SliceLimbs(a, 0, half);
+	AddLimbsTo(fullRemainder, remainder, half);
+	std::vector<unsigned long long> one(1, 1);
+	while (CompareLimbs(fullRemainder.data(), fullRemainder.size(), product.data(), product.size()) < 0) {
+		AddLimbsTo(fullRemainder, b);
+		SubtractLimbsFrom(quotient, one);
+	}
+	SubtractLimbsFrom(fullRemainder, product);
+	remainder.swap(fullRemainder);
+}
+
+/*	Approximate reciprocal by Newton's iteration ("Modern Computer Arithmetic", Brent and Zimmermann, Algorithm 3.5):
+*	For a of (n) limbs with its highest bit set, returns x such that a * x < 2^(128*n) <= a * (x + 2).
+*	The reciprocal of the higher half of a is computed recursively, then one Newton step doubles its precision:
+*	x = xh * X + xh * (2^(64*(n+h)) - a * xh) / 2^(64*(2h)), where X = 2^(64*l), h = n - l is the size of the higher half.
+*	Each step costs about 2 multiplications, and the sizes are halved, so the whole reciprocal costs a few multiplications.
+*/
+static std::vector<unsigned long long> ApproximateReciprocal(const std::vector<unsigned long long>& a)
+{
+	unsigned int size = a.size();
+	if (size < NEWTON_THRESHOLD / 2) {
+		// (2^(128*n) - 1) / a directly, which satisfies the condition above
+		std::vector<unsigned long long> allOnes(2 * size, ~0ULL), quotient, remainder;
+		DivideLimbVectors(allOnes, a, quotient, remainder);
+		return quotient;
+	}
+
+	unsigned int lowSize = (size - 1) >> 1, highSize = size - lowSize;
+	std::vector<unsigned long long> highReciprocal = ApproximateReciprocal(SliceLimbs(a, lowSize, highSize));
+
+	std::vector<unsigned long long> product = MultiplyLimbVectors(a, highReciprocal);
+	std::vector<unsigned long long> bound(size + highSize + 1, 0), one(1, 1);
+	bound.back() = 1; // 2^(64*(n+h))
+	while (CompareLimbs(product.data(), product.size(), bound.data(), bound.size()) >= 0) {
+		SubtractLimbsFrom(highReciprocal, one);
+		SubtractLimbsFrom(product, a);
+	}
+	SubtractLimbsFrom(bound, product);
+
+	std::vector<unsigned long long> correction = MultiplyLimbVectors(SliceLimbs(bound, lowSize, bound.size()), highReciprocal);
+	std::vector<unsigned long long> result = SliceLimbs(correction, 2 * highSize - lowSize, correction.size());
+	AddLimbsTo(result, highReciprocal, lowSize);
+	return result;
+}
+
+// quotient = a / b, remainder = a % b by the reciprocal of b, where b has (size) limbs with its highest bit set, and a < b * 2^(64*size)
+static void DivideByReciprocal(const std::vector<unsigned long long>& a, const std::vector<unsigned long long>& b,
+	const std::vector<unsigned long long>& reciprocal, unsigned int size,
+	std::vector<unsigned long long>& quotient, std::vector<unsigned long long>& remainder)
+{
+	// The estimate (a * reciprocal / 2^(128*size)) is never greater than the actual quotient, and at most 3 less than it
+	quotient = SliceLimbs(MultiplyLimbVectors(a, reciprocal), 2 * size, size + 2);
+	remainder = a;
+	SubtractLimbsFrom(remainder, MultiplyLimbVectors(quotient, b));
+	std::vector<unsigned long long> one(1, 1);
+	while (CompareLimbs(remainder.data(), remainder.size(), b.data(), b.size()) >= 0) {
+		SubtractLimbsFrom(remainder, b);
+		AddLimbsTo(quotient, one);
+	}
+}
+
+/*	Divides u by a large v in blocks of (size) limbs, where (size) is at least the size of v:
+*	Both numbers are shifted to the left until v has exactly (size) limbs with its highest bit set,
+*	then u is divided from the most significant blocks, each step divides (remainder * 2^(64*size) + next block) by v
+*	using either Burnikel-Ziegler or the reciprocal of v (which is computed once).
+*	For Burnikel-Ziegler, the size is (j * 2^k), where j is less than the threshold, so that the recursion halves evenly.
+*/
+static void DivideInBlocks(const std::vector<unsigned long long>& u, const std::vector<unsigned long long>& v,
+	std::vector<unsigned long long>& quotient, std::vector<unsigned long long>& remainder, bool useReciprocal)
+{
+	unsigned int size = v.size();
+	if (!useReciprocal) {
+		unsigned int blocks = 1;
+		while (blocks <= size / BURNIKEL_ZIEGLER_THRESHOLD)
+			blocks <<= 1;
+		size = (size + blocks - 1) / blocks * blocks;
+	}
+
+	unsigned long long shift = 64ULL * size - BitLengthOfLimbs(v);
+	std::vector<unsigned long long> shiftedV = ShiftLimbsLeft(v, shift), shiftedU = ShiftLimbsLeft(u, shift), reciprocal;
+	if (useReciprocal)
+		reciprocal = ApproximateReciprocal(shiftedV);
+
+	// The highest block must be less than v, so there is a spare bit at least
+	unsigned int blockCount = std::max((unsigned int)((BitLengthOfLimbs(shiftedU) + 64ULL * size) / (64ULL * size)), 2U);
+	std::vector<unsigned long long> current = SliceLimbs(shiftedU, (blockCount - 2) * size, 2 * size), blockQuotient;
+	quotient.assign((blockCount - 1) * size, 0);
+	for (unsigned int i = blockCount - 1; i-- > 0; ) {
+		if (useReciprocal)
+			DivideByReciprocal(current, shiftedV, reciprocal, size, blockQuotient, remainder);
+		else
+			DivideTwoByOne(current, shiftedV, size, blockQuotient, remainder);
+		std::copy(blockQuotient.begin(), blockQuotient.end(), quotient.begin() + i * size);
+		if (i > 0) {
+			current = SliceLimbs(shiftedU, (i - 1) * size, size);
+			AddLimbsTo(current, remainder, size);
+		}
+	}
+	TrimLimbs(quotient);
+	remainder = ShiftLimbsRight(remainder, shift);
+}
+
+// quotient = u / v, remainder = u % v, where v is not zero. This selects the algorithm by the sizes.
+static void DivideLimbVectors(const std::vector<unsigned long long>& u, const std::vector<unsigned long long>& v,
+	std::vector<unsigned long long>& quotient, std::vector<unsigned long long>& remainder)
+{
+	unsigned int quotientSize = u.size() >= v.size() ? u.size() - v.size() + 1 : 0;
+	if (v.size() < BURNIKEL_ZIEGLER_THRESHOLD || quotientSize < BURNIKEL_ZIEGLER_THRESHOLD)
+		DivideLimbVectorsBasecase(u, v, quotient, remainder);
+	else
+		DivideInBlocks(u, v, quotient, remainder, v.size() >= NEWTON_THRESHOLD);
+}
+
+// Radix conversion between limbs and packets of 9 decimal digits (the layout of decimalContents, starting from 0 at least significant)
+
+// powers[k] = 10^(9 * 2^k) for k in [0, count), each one is the square of the previous one
+static std::vector<std::vector<unsigned long long>> DecimalPowers(unsigned int count)
+{
+	std::vector<std::vector<unsigned long long>> powers(1, std::vector<unsigned long long>(1, E9));
+	while (powers.size() < count)
+		powers.push_back(MultiplyLimbVectors(powers.back(), powers.back()));
+	return powers;
+}
+
+// Writes x into packets[0 .. count) by dividing repeatedly by 10^18 (2 packets at a time), where x < 10^(9 * count)
+static void LimbsToPacketsBasecase(std::vector<unsigned long long> x, unsigned int* packets, unsigned int count)
+{
+	unsigned int size = x.size(), written = 0;
+	while (size > 0 && written < count) {
+		unsigned long long packetNumber = DivideLimbsBySingle(x.data(), x.data(), size, E18);
+		while (size > 0 && x[size - 1] == 0)
+			size--;
+		packets[written++] = (unsigned int) (packetNumber % E9);
+		if (written < count)
+			packets[written++] = (unsigned int) (packetNumber / E9);
+	}
+	std::fill(packets + written, packets + count, 0);
+}
+
+/*	Divide-and-conquer conversion to decimal: writes x into packets[0 .. 2^level), where x < powers[level].
+*	x is split into its higher and lower halves in decimal by a single division by powers[level - 1],
+*	and each half is converted recursively into its own part of the output, so no packet is moved after it is written.
+*	The divisions are balanced, so the whole conversion follows the speed of the division (and multiplication).
+*/
+static void LimbsToPackets(const std::vector<unsigned long long>& x, const std::vector<std::vector<unsigned long long>>& powers,
+	unsigned int level, unsigned int* packets)
+{
+	if (x.size() < DECIMAL_CONVERSION_THRESHOLD) {
+		LimbsToPacketsBasecase(x, packets, 1U << level);
+		return;
+	}
+	std::vector<unsigned long long> higher, lower;
+	DivideLimbVectors(x, powers[level - 1], higher, lower);
+	LimbsToPackets(lower, powers, level - 1, packets);
+	LimbsToPackets(higher, powers, level - 1, packets + (1U << (level - 1)));
+}
+
+// Returns the value of packets[0 .. count) by multiplying by 10^18 and adding 2 packets at a time (in-place, linear for each step)
+static std::vector<unsigned long long> PacketsToLimbsBasecase(const unsigned int* packets, unsigned int count)
+{
+	std::vector<unsigned long long> result(1, count & 1 ? packets[count - 1] : 0);
+	result.reserve(count / 2 + 2);
+	for (unsigned int i = count & ~1U; i > 0; i -= 2) {
+		unsigned long long packetNumber = packets[i - 1] * (unsigned long long) E9 + packets[i - 2];
+		unsigned long long carry = MultiplyRow(result.data(), result.data(), result.size(), E18, packetNumber);
+		if (carry != 0)
+			result.push_back(carry);
+	}
+	return result;
+}
+
+/*	Divide-and-conquer conversion from decimal: returns the value of packets[0 .. count), where count <= 2^(powers.size()).
+*	The packets are split at the highest power of 2 below count (2^k), then (higher * 10^(9 * 2^k) + lower),
+*	so the work is done by a few big multiplications instead of a multiplication by 10^18 for each pair of packets.
+*/
+static std::vector<unsigned long long> PacketsToLimbs(const unsigned int* packets, unsigned int count,
+	const std::vector<std::vector<unsigned long long>>& powers)
+{
+	if (count < 2 * DECIMAL_CONVERSION_THRESHOLD)
+		return PacketsToLimbsBasecase(packets, count);
+	unsigned int level = 0;
+	while ((2U << level) < count)
+		level++;
+	std::vector<unsigned long long> lower = PacketsToLimbs(packets, 1U << level, powers);
+	std::vector<unsigned long long> higher = PacketsToLimbs(packets + (1U << level), count - (1U << level), powers);
+	std::vector<unsigned long long> result = MultiplyLimbVectors(higher, powers[level]);
+	AddLimbsTo(result, lower);
+	TrimLimbs(result);
+	return result;
+}
+
+// The smallest level such that a number of (bits) bits is less than 10^(9 * 2^level) (as 2^29 < 10^9)
+static unsigned int DecimalLevelOfBits(unsigned long long bits)
+{
+	unsigned int level = 0;
+	while ((29ULL << level) < bits)
+		level++;
+	return level;
+}
+
+/*	Montgomery arithmetic modulo an odd number m of (size) limbs, where R = 2^(64*size):
+*	A number x is kept as (x * R mod m), so the product of two of them only needs a division by R instead of a division by m,
+*	which is done by adding a multiple of m that makes the lower (size) limbs zeros (Montgomery's reduction, REDC).
+*/
+
+// After a reduction: result[0 .. size) = t[0 .. size] mod m, where t < 2m
+static void MontgomeryFinalSubtract(const unsigned long long* t, const unsigned long long* m, unsigned int size, unsigned long long* result)
+{
+	if (t[size] != 0 || CompareLimbs(t, size, m, size) >= 0)
+		SubtractLimbs(result, t, size, m, size); // the borrow cancels t[size]
+	else if (result != t)
+		std::copy(t, t + size, result);
+}
+
+// -m^-1 mod R by Newton's iteration on the limbs, which doubles the correct limbs each step (only needed by the bulk reduction)
+static std::vector<unsigned long long> MontgomeryInverseLimbs(const unsigned long long* m, unsigned int size)
+{
+	std::vector<unsigned long long> inverse(1, 0 - NegativeInverseOfLimb(m[0])), error, product;
+	for (unsigned int count = 1; count < size; ) {
+		unsigned int newCount = std::min(2 * count, size);
+		// error = 2 - m * inverse (mod 2^(64*newCount)), then inverse = inverse * error (mod 2^(64*newCount))
+		error.resize(newCount + count);
+		MultiplyLimbs(m, newCount, inverse.data(), count, error.data());
+		error.resize(newCount);
+		for (unsigned long long& limb : error)
+			limb = ~limb;
+		AddLimb(error.data(), error.data(), newCount, 3); // 2 - x = ~x + 3
+		product.resize(newCount + count);
+		MultiplyLimbs(error.data(), newCount, inverse.data(), count, product.data());
+		inverse.assign(product.begin(), product.begin() + newCount);
+		count = newCount;
+	}
+	for (unsigned long long& limb : inverse)
+		limb = ~limb;
+	AddLimb(inverse.data(), inverse.data(), size, 1);
+	return inverse;
+}
+
+/*	result[0 .. size) = t * R^-1 mod m, where t[0 .. 2*size] < m * R (t is changed).
+*	Small moduli are reduced limb by limb: t += (t[i] * inverse mod 2^64) * m * 2^(64*i), which makes t[i] zero.
+*	Big moduli are reduced at once: t += ((t mod R) * inverseLimbs mod R) * m, by 2 multiplications with the selected algorithms.
+*	scratch needs 4*size limbs for the big moduli.
+*/
+static void MontgomeryReduce(unsigned long long* t, const unsigned long long* m, unsigned int size, unsigned long long inverse,
+	const unsigned long long* inverseLimbs, unsigned long long* result, unsigned long long* scratch)
+{
+	if (size < MONTGOMERY_REDC_THRESHOLD) {
+		for (unsigned int i = 0; i < size; i++) {
+			unsigned long long carry = MultiplyAddRow(t + i, m, size, t[i] * inverse);
+			AddLimb(t + i + size, t + i + size, size + 1 - i, carry);
+		}
+	}
+	else {
+		unsigned long long* quotient = scratch;
+		unsigned long long* product = scratch + 2 * size;
+		MultiplyLimbs(t, size, inverseLimbs, size, quotient);
+		MultiplyLimbs(quotient, size, m, size, product);
+		AddLimbs(t, t, 2 * size + 1, product, 2 * size);
+	}
+	MontgomeryFinalSubtract(t + size, m, size, result);
+}
+
+/*	result[0 .. size) = a * b * R^-1 mod m, where a, b < m. result may be the same array as a or b, and a may be the same as b (squaring).
+*	For small moduli, each limb of b is multiplied and reduced right away (the multiplication and the reduction in the same pass),
+*	otherwise the product is calculated by MultiplyLimbs or SquareLimbs and then reduced. scratch needs 6*size + 1 limbs.
+*/
+static void MontgomeryMultiplyLimbs(const unsigned long long* a, const unsigned long long* b, const unsigned long long* m, unsigned int size,
+	unsigned long long inverse, const unsigned long long* inverseLimbs, unsigned long long* result, unsigned long long* scratch)
+{
+	unsigned long long* t = scratch;
+	if (size < MONTGOMERY_REDC_THRESHOLD && a != b) {
+		std::fill(t, t + 2 * size + 1, 0ULL);
+		for (unsigned int i = 0; i < size; i++) {
+			unsigned long long carry = MultiplyAddRow(t + i, a, size, b[i]);
+			AddLimb(t + i + size, t + i + size, size + 1 - i, carry);
+			carry = MultiplyAddRow(t + i, m, size, t[i] * inverse);
+			AddLimb(t + i + size, t + i + size, size + 1 - i, carry);
+		}
+		MontgomeryFinalSubtract(t + size, m, size, result);
+		return;
+	}
+
+	if (a == b)
+		SquareLimbs(a, size, t);
+	else
+		MultiplyLimbs(a, size, b, size, t);
+	t[2 * size] = 0;
+	MontgomeryReduce(t, m, size, inverse, inverseLimbs, result, t + 2 * size + 1);
+}
+
+/*	Barrett reduction: result[0 .. size) = x mod m, where m has (size) limbs, x has up to 2*size limbs, and mu = 2^(128*size) / m.
+*	With b = 2^64, the quotient is estimated as q = ((x / b^(size-1)) * mu) / b^(size+1), which is at most 2 less than the actual one,
+*	then r = x - q*m is calculated modulo b^(size+1) (the higher limbs of both are the same), and m is subtracted until r < m.
+*	For sizes below BARRETT_HALF_PRODUCT_THRESHOLD, only the columns of the first product from (size - 1) upwards and the lower (size + 1) limbs of the second
+*	are calculated, which is half of the work of the full products. The skipped columns add up to less than b^(size+1), so q is at most 1 less.
+*	scratch needs 5*size + 6 limbs.
+*/
+static void BarrettReduceLimbs(const unsigned long long* x, unsigned int xSize, const unsigned long long* m, unsigned int size,
+	const unsigned long long* mu, unsigned int muSize, unsigned long long* result, unsigned long long* scratch)
+{
+	if (xSize < size) {
+		// x < b^(size-1) <= m
+		std::copy(x, x + xSize, result);
+		std::fill(result + xSize, result + size, 0ULL);
+		return;
+	}
+
+	const unsigned long long* top = x + size - 1;
+	unsigned int topSize = xSize - size + 1, estimateSize = topSize + muSize;
+	unsigned long long* estimate = scratch;
+	unsigned long long* remainder = estimate + estimateSize;
+	unsigned long long* product = remainder + size + 1;
+	bool partialProducts = size < BARRETT_HALF_PRODUCT_THRESHOLD;
+
+	// The first product (only its limbs from (size + 1) upwards are used)
+	if (partialProducts) {
+		std::fill(estimate, estimate + estimateSize, 0ULL);
+		for (unsigned int j = 0; j < muSize; j++) {
+			unsigned int from = j + 1 >= size ? 0 : size - 1 - j; // the columns (i + j) below (size - 1) are skipped
+			if (from < topSize)
+				estimate[topSize + j] = MultiplyAddRow(estimate + from + j, top + from, topSize - from, mu[j]);
+		}
+	}
+	else
+		MultiplyLimbs(top, topSize, mu, muSize, estimate);
+
+	// q = estimate / b^(size+1), and only (q mod b^(size+1)) is needed for the lower limbs of q*m
+	unsigned int quotientSize = std::min(estimateSize - std::min(estimateSize, size + 1), size + 1);
+	const unsigned long long* quotient = estimate + size + 1;
+	std::fill(remainder, remainder + size + 1, 0ULL);
+	std::copy(x, x + std::min(xSize, size + 1), remainder);
+	if (quotientSize > 0) {
+		// The second product (only its lower (size + 1) limbs)
+		if (partialProducts) {
+			std::fill(product, product + size + 1, 0ULL);
+			for (unsigned int j = 0; j < quotientSize; j++) {
+				unsigned int count = std::min(size, size + 1 - j);
+				unsigned long long carry = MultiplyAddRow(product + j, m, count, quotient[j]);
+				if (j + count <= size)
+					product[j + count] += carry;
+			}
+		}
+		else
+			MultiplyLimbs(quotient, quotientSize, m, size, product);
+		SubtractLimbs(remainder, remainder, size + 1, product, size + 1); // modulo b^(size+1)
+	}
+	while (CompareLimbs(remainder, size + 1, m, size) >= 0)
+		SubtractLimbs(remainder, remainder, size + 1, m, size);
+	std::copy(remainder, remainder + size, result);
+}
+
+/*	GCD:
+*	The numbers are reduced by a sequence of quotients (as in Euclid's algorithm), collected in a matrix M with (a; b) = M * (a'; b'),
+*	where M is a product of the matrices (1 q; 0 1) and (1 0; q 1), so its determinant is 1 and M^-1 = (M11 -M01; -M10 M00).
+*	- Lehmer's algorithm finds the first quotients from the top 2 limbs of the numbers only, then applies all of them at once.
+*	- The half-GCD (Moeller's version of Schoenhage's algorithm) finds the quotients that reduce the numbers to half of their size
+*	  recursively from the top halves, so the work is done by multiplications of the matrices and the numbers.
+*/
+
+// Binary GCD of two 64-bit integers: the common factors of 2 are taken out, then the smaller number is subtracted from the greater one
+// (which makes it even) and the factors of 2 are removed, until it is 0
+static unsigned long long BinaryGcdOfLimbs(unsigned long long a, unsigned long long b)
+{
+	if (a == 0 || b == 0)
+		return a | b;
+	unsigned int commonZeros = CountTrailingZeros(a | b);
+	a >>= CountTrailingZeros(a);
+	while (b != 0) {
+		b >>= CountTrailingZeros(b);
+		if (a > b)
+			std::swap(a, b);
+		b -= a;
+	}
+	return a << commonZeros;
+}
+
+// The number of limbs without the leading zero limbs
+static unsigned int NormalizedSize(const unsigned long long* limbs, unsigned int size)
+{
+	while (size > 0 && limbs[size - 1] == 0)
+		size--;
+	return size;
+}
+
+// q = (high : low) / (divisorHigh : divisorLow), where divisorHigh > 0 (so q fits in 64 bits), and (high : low) is replaced by the remainder.
+// The quotients of the GCD are usually small, so they are found bit by bit instead of a general division.
+static unsigned long long DivideDoubleLimb(unsigned long long& high, unsigned long long& low, unsigned long long divisorHigh,
+	unsigned long long divisorLow)
+{
+	if (high < divisorHigh)
+		return 0;
+	unsigned int shift = CountLeadingZeros(divisorHigh) - CountLeadingZeros(high);
+	if (shift != 0) {
+		divisorHigh = (divisorHigh << shift) | (divisorLow >> (64 - shift));
+		divisorLow <<= shift;
+	}
+	unsigned long long quotient = 0;
+	for (unsigned int i = 0; i <= shift; i++) {
+		quotient <<= 1;
+		if (high > divisorHigh || (high == divisorHigh && low >= divisorLow)) {
+			quotient |= 1;
+			high -= divisorHigh + (low < divisorLow);
+			low -= divisorLow;
+		}
+		divisorLow = (divisorLow >> 1) | (divisorHigh << 63);
+		divisorHigh >>= 1;
+	}
+	return quotient;
+}
+
+/*	Lehmer's step: the quotients of (a, b) are found from their top 2 limbs (ah : al) and (bh : bl) (both shifted by the same amount).
+*	A quotient of the approximations is only taken while they stay at least 2^65 after it, which guarantees that it is the same
+*	as the quotient of the whole numbers (as in Moeller's hgcd2). Below 2^96 the top 64 bits are used, and the limit is 2^33.
+*	The quotients are collected in the matrix M (with single-limb elements). Returns false if no quotient is certain.
+*/
+static bool LehmerMatrix(unsigned long long ah, unsigned long long al, unsigned long long bh, unsigned long long bl,
+	unsigned long long matrix[2][2])
+{
+	const unsigned long long halfLimb = 1ULL << 32, singleLimit = 1ULL << 33;
+	unsigned long long m00, m01, m10, m11, quotient;
+	if (ah < 2 || bh < 2)
+		return false;
+
+	// The first subtraction
+	if (ah > bh || (ah == bh && al > bl)) {
+		ah -= bh + (al < bl);
+		al -= bl;
+		if (ah < 2)
+			return false;
+		m00 = m01 = m11 = 1;
+		m10 = 0;
+	}
+	else {
+		bh -= ah + (bl < al);
+		bl -= al;
+		if (bh < 2)
+			return false;
+		m00 = m10 = m11 = 1;
+		m01 = 0;
+	}
+
+	// Double precision: a -= q * b (the second column of M) and b -= q * a (the first column of M) in turns.
+	// Each of them subtracts once before dividing, since the quotients are mostly 1.
+	bool reduceA = ah >= bh;
+	for (;;) {
+		if (reduceA) {
+			if (ah == bh)
+				goto done;
+			if (ah < halfLimb) {
+				ah = (ah << 32) + (al >> 32);
+				bh = (bh << 32) + (bl >> 32);
+				break;
+			}
+			ah -= bh + (al < bl);
+			al -= bl;
+			if (ah < 2)
+				goto done;
+			if (ah <= bh) {
+				m01 += m00;
+				m11 += m10;
+			}
+			else {
+				quotient = DivideDoubleLimb(ah, al, bh, bl);
+				if (ah >= 2)
+					quotient++;
+				m01 += quotient * m00;
+				m11 += quotient * m10;
+				if (ah < 2)
+					goto done;	// the remainder is too small, so only q is taken (and a stays q * b greater)
+			}
+		}
+		else {
+			if (ah == bh)
+				goto done;
+			if (bh < halfLimb) {
+				ah = (ah << 32) + (al >> 32);
+				bh = (bh << 32) + (bl >> 32);
+				break;
+			}
+			bh -= ah + (bl < al);
+			bl -= al;
+			if (bh < 2)
+				goto done;
+			if (bh <= ah) {
+				m00 += m01;
+				m10 += m11;
+			}
+			else {
+				quotient = DivideDoubleLimb(bh, bl, ah, al);
+				if (bh >= 2)
+					quotient++;
+				m00 += quotient * m01;
+				m10 += quotient * m11;
+				if (bh < 2)
+					goto done;
+			}
+		}
+		reduceA = !reduceA;
+	}
+
+	// Single precision on the top 64 bits of the 96-bit values
+	for (;;) {
+		if (reduceA) {
+			ah -= bh;
+			if (ah < singleLimit)
+				break;
+			if (ah <= bh) {
+				m01 += m00;
+				m11 += m10;
+			}
+			else {
+				quotient = ah / bh;
+				ah -= quotient * bh;
+				if (ah >= singleLimit)
+					quotient++;
+				m01 += quotient * m00;
+				m11 += quotient * m10;
+				if (ah < singleLimit)
+					break;
+			}
+		}
+		else {
+			bh -= ah;
+			if (bh < singleLimit)
+				break;
+			if (bh <= ah) {
+				m00 += m01;
+				m10 += m11;
+			}
+			else {
+				quotient = bh / ah;
+				bh -= quotient * ah;
+				if (bh >= singleLimit)
+					quotient++;
+				m00 += quotient * m01;
+				m10 += quotient * m11;
+				if (bh < singleLimit)
+					break;
+			}
+		}
+		reduceA = !reduceA;
+	}
+
+done:
+	matrix[0][0] = m00;
+	matrix[0][1] = m01;
+	matrix[1][0] = m10;
+	matrix[1][1] = m11;
+	return true;
+}
+
+// (a; b) = M^-1 * (a; b) for a matrix of single limbs: a = m11 * a - m01 * b, b = m00 * b - m10 * a (both results are not negative).
+// scratch needs 2*size limbs. Returns the new size (of the greater one).
+static unsigned int ApplyInverseMatrix1(const unsigned long long matrix[2][2], unsigned long long* a, unsigned long long* b, unsigned int size,
+	unsigned long long* scratch)
+{
+	unsigned long long* newA = scratch;
+	unsigned long long* newB = scratch + size;
+	MultiplyRow(newA, a, size, matrix[1][1]);
+	MultiplySubtractRow(newA, b, size, matrix[0][1]);
+	MultiplyRow(newB, b, size, matrix[0][0]);
+	MultiplySubtractRow(newB, a, size, matrix[1][0]);
+	std::copy(newA, newA + size, a);
+	std::copy(newB, newB + size, b);
+	return std::max(NormalizedSize(a, size), NormalizedSize(b, size));
+}
+
+// A matrix of big numbers (trimmed vectors) for the half-GCD, which starts as the identity
+struct GcdMatrix
+{
+	std::vector<unsigned long long> elements[2][2] = { { { 1 }, { 0 } }, { { 0 }, { 1 } } };
+};
+
+// (row) = (row) * other, for a single row of a matrix (such as the cofactors of the extended GCD)
+static void MultiplyGcdMatrixRow(std::vector<unsigned long long> row[2], const GcdMatrix& other)
+{
+	std::vector<unsigned long long> first = MultiplyLimbVectors(row[0], other.elements[0][0]);
+	AddLimbsTo(first, MultiplyLimbVectors(row[1], other.elements[1][0]));
+	std::vector<unsigned long long> second = MultiplyLimbVectors(row[0], other.elements[0][1]);
+	AddLimbsTo(second, MultiplyLimbVectors(row[1], other.elements[1][1]));
+	row[0].swap(first);
+	row[1].swap(second);
+}
+
+// M = M * other
+static void MultiplyGcdMatrices(GcdMatrix& matrix, const GcdMatrix& other)
+{
+	MultiplyGcdMatrixRow(matrix.elements[0], other);
+	MultiplyGcdMatrixRow(matrix.elements[1], other);
+}
+
+// After reducing (column) by q times the other number: the other column of M += q * (column) of M
+static void AddGcdMatrixColumn(GcdMatrix& matrix, unsigned int column, const std::vector<unsigned long long>& quotient)
+{
+	for (unsigned int row = 0; row < 2; row++)
+		AddLimbsTo(matrix.elements[row][1 - column], MultiplyLimbVectors(quotient, matrix.elements[row][column]));
+}
+
+/*	(a; b) = M^-1 * (a; b), where the higher parts a[p .. size) and b[p .. size) were already reduced by M (by the half-GCD of the higher parts):
+*	a = a' * 2^(64*p) + (M11 * a0 - M01 * b0), b = b' * 2^(64*p) + (M00 * b0 - M10 * a0), where a0 and b0 are the lower p limbs.
+*	Returns the new size (of the greater one).
+*/
+static unsigned int AdjustByGcdMatrix(const GcdMatrix& matrix, unsigned long long* a, unsigned long long* b, unsigned int p, unsigned int size)
+{
+	std::vector<unsigned long long> aLow(a, a + p), bLow(b, b + p);
+	TrimLimbs(aLow);
+	TrimLimbs(bLow);
+	unsigned long long* numbers[2] = { a, b };
+	const std::vector<unsigned long long>* lows[2] = { &aLow, &bLow };
+	for (unsigned int i = 0; i < 2; i++) {
+		// i = 0: a' * 2^(64*p) + M11 * a0 - M01 * b0, i = 1: b' * 2^(64*p) + M00 * b0 - M10 * a0
+		std::vector<unsigned long long> result(size, 0);
+		std::copy(numbers[i] + p, numbers[i] + size, result.begin() + p);
+		TrimLimbs(result);
+		AddLimbsTo(result, MultiplyLimbVectors(matrix.elements[1 - i][1 - i], *lows[i]));
+		SubtractLimbsFrom(result, MultiplyLimbVectors(matrix.elements[i][1 - i], *lows[1 - i]));
+		std::fill(numbers[i], numbers[i] + size, 0ULL);
+		std::copy(result.begin(), result.begin() + std::min((unsigned int)result.size(), size), numbers[i]);
+	}
+	return std::max(NormalizedSize(a, size), NormalizedSize(b, size));
+}
+
+/*	A single step of the half-GCD that keeps both numbers greater than 2^(64*s): subtracts the smaller number from the greater one,
+*	then divides the greater one by the smaller one (taking 1 less from the quotient if the remainder would be too small).
+*	The quotients are added to M. Returns the new size, or 0 if the numbers cannot be reduced any further.
+*/
+static unsigned int SubtractDivideStep(unsigned long long* a, unsigned long long* b, unsigned int size, unsigned int s, GcdMatrix& matrix)
+{
+	unsigned long long* smaller = a;
+	unsigned long long* greater = b;
+	unsigned int smallerSize = NormalizedSize(a, size), greaterSize = NormalizedSize(b, size), greaterColumn = 1;
+	signed int comparison = CompareLimbs(a, smallerSize, b, greaterSize);
+	if (comparison == 0)
+		return 0;
+	if (comparison > 0) {
+		std::swap(smaller, greater);
+		std::swap(smallerSize, greaterSize);
+		greaterColumn = 0;
+	}
+	if (smallerSize <= s)
+		return 0;
+
+	SubtractLimbs(greater, greater, greaterSize, smaller, smallerSize);
+	greaterSize = NormalizedSize(greater, greaterSize);
+	if (greaterSize <= s) {
+		// Undo the subtraction
+		unsigned long long carry = AddLimbs(greater, smaller, smallerSize, greater, greaterSize);
+		if (carry)
+			greater[smallerSize] = carry;
+		return 0;
+	}
+	AddGcdMatrixColumn(matrix, greaterColumn, std::vector<unsigned long long>(1, 1));
+
+	comparison = CompareLimbs(smaller, smallerSize, greater, greaterSize);
+	if (comparison == 0)
+		return smallerSize;
+	if (comparison > 0) {
+		std::swap(smaller, greater);
+		std::swap(smallerSize, greaterSize);
+		greaterColumn = 1 - greaterColumn;
+	}
+
+	std::vector<unsigned long long> quotient, remainder;
+	DivideLimbVectors(std::vector<unsigned long long>(greater, greater + greaterSize),
+		std::vector<unsigned long long>(smaller, smaller + smallerSize), quotient, remainder);
+	unsigned int remainderSize = NormalizedSize(remainder.data(), remainder.size());
+	if (remainderSize <= s) {
+		// The quotient is 1 too large
+		remainder.resize(smallerSize + 1, 0);
+		remainder[smallerSize] = AddLimbs(remainder.data(), smaller, smallerSize, remainder.data(), remainderSize);
+		SubtractLimb(quotient.data(), quotient.data(), quotient.size(), 1);
+		TrimLimbs(quotient);
+	}
+	std::fill(greater, greater + greaterSize, 0ULL);
+	std::copy(remainder.begin(), remainder.begin() + NormalizedSize(remainder.data(), remainder.size()), greater);
+	if (!(quotient.size() == 1 && quotient[0] == 0))
+		AddGcdMatrixColumn(matrix, greaterColumn, quotient);
+	return smallerSize;
+}
+
+// A step of the half-GCD: Lehmer's step on the top 2 limbs, or a subtraction and division if it is not possible. Returns 0 if nothing is done.
+static unsigned int HalfGcdStep(unsigned long long* a, unsigned long long* b, unsigned int size, unsigned int s, GcdMatrix& matrix,
+	std::vector<unsigned long long>& scratch)
+{
+	unsigned long long mask = a[size - 1] | b[size - 1], ah, al, bh, bl;
+	if (size == s + 1) {
+		// Without shifting, so the reduced numbers are still greater than 2^(64*s)
+		if (mask < 4)
+			return SubtractDivideStep(a, b, size, s, matrix);
+		ah = a[size - 1], al = a[size - 2], bh = b[size - 1], bl = b[size - 2];
+	}
+	else {
+		unsigned int shift = CountLeadingZeros(mask);
+		ah = a[size - 1], al = a[size - 2], bh = b[size - 1], bl = b[size - 2];
+		if (shift != 0) {
+			ah = (ah << shift) | (al >> (64 - shift));
+			al = (al << shift) | (a[size - 3] >> (64 - shift));
+			bh = (bh << shift) | (bl >> (64 - shift));
+			bl = (bl << shift) | (b[size - 3] >> (64 - shift));
+		}
+	}
+
+	unsigned long long lehmer[2][2];
+	if (!LehmerMatrix(ah, al, bh, bl, lehmer))
+		return SubtractDivideStep(a, b, size, s, matrix);
+	GcdMatrix step;
+	for (unsigned int row = 0; row < 2; row++)
+		for (unsigned int column = 0; column < 2; column++)
+			step.elements[row][column].assign(1, lehmer[row][column]);
+	MultiplyGcdMatrices(matrix, step);
+	scratch.resize(2 * size);
+	return ApplyInverseMatrix1(lehmer, a, b, size, scratch.data());
+}
+
+/*	Half-GCD: reduces a, b (of (size) limbs, in-place) until one more quotient would make them smaller than 2^(64*s), where s = size/2 + 1,
+*	and multiplies M by the quotients. Returns the new size, or 0 if nothing is done.
+*	The higher half is reduced recursively first (its quotients are the same as the whole numbers' up to about half of its size),
+*	then a few steps, then the higher half of the rest recursively again.
+*/
+static unsigned int HalfGcd(unsigned long long* a, unsigned long long* b, unsigned int size, GcdMatrix& matrix,
+	std::vector<unsigned long long>& scratch)
+{
+	unsigned int s = size / 2 + 1;
+	if (size <= s)
+		return 0;
+	bool success = false;
+
+	if (size >= HALF_GCD_THRESHOLD) {
+		unsigned int p = size / 2, limit = (3 * size) / 4 + 1;
+		GcdMatrix first;
+		unsigned int newSize = HalfGcd(a + p, b + p, size - p, first, scratch);
+		if (newSize > 0) {
+			size = AdjustByGcdMatrix(first, a, b, p, size);
+			MultiplyGcdMatrices(matrix, first);
+			success = true;
+		}
+		while (size > limit) {
+			newSize = HalfGcdStep(a, b, size, s, matrix, scratch);
+			if (newSize == 0)
+				return success ? size : 0;
+			size = newSize;
+			success = true;
+		}
+		if (size > s + 2) {
+			p = 2 * s - size + 1;
+			GcdMatrix second;
+			newSize = HalfGcd(a + p, b + p, size - p, second, scratch);
+			if (newSize > 0) {
+				size = AdjustByGcdMatrix(second, a, b, p, size);
+				MultiplyGcdMatrices(matrix, second);
+				success = true;
+			}
+		}
+	}
+
+	for (;;) {
+		unsigned int newSize = HalfGcdStep(a, b, size, s, matrix, scratch);
+		if (newSize == 0)
+			return success ? size : 0;
+		size = newSize;
+		success = true;
+	}
+}
+
+// A step of Euclid's algorithm on the whole numbers: the greater one = the greater one mod the smaller one (the numbers are not swapped),
+// and the quotient is added to the cofactors (if any). Returns the new size, or 0 if the smaller one is 0 (then the GCD is the other one).
+static unsigned int EuclidStep(std::vector<unsigned long long>& a, std::vector<unsigned long long>& b, unsigned int size,
+	std::vector<unsigned long long>* cofactors)
+{
+	std::vector<unsigned long long>* greater = &a;
+	std::vector<unsigned long long>* smaller = &b;
+	unsigned int greaterSize = NormalizedSize(a.data(), size), smallerSize = NormalizedSize(b.data(), size), greaterColumn = 0;
+	if (CompareLimbs(a.data(), greaterSize, b.data(), smallerSize) < 0) {
+		std::swap(greater, smaller);
+		std::swap(greaterSize, smallerSize);
+		greaterColumn = 1;
+	}
+	if (smallerSize == 0)
+		return 0;
+	std::vector<unsigned long long> quotient, remainder;
+	DivideLimbVectors(std::vector<unsigned long long>(greater->begin(), greater->begin() + greaterSize),
+		std::vector<unsigned long long>(smaller->begin(), smaller->begin() + smallerSize), quotient, remainder);
+	std::fill(greater->begin(), greater->end(), 0ULL);
+	std::copy(remainder.begin(), remainder.end(), greater->begin());
+	if (cofactors != nullptr)
+		AddLimbsTo(cofactors[1 - greaterColumn], MultiplyLimbVectors(quotient, cofactors[greaterColumn]));
+	return smallerSize;
+}
+
+/*	Reduces a and b (both not 0, of the same size) by the half-GCD and Lehmer's algorithm until one of them is 0 or both have a single limb,
+*	and returns the size. If cofactors is not null, it is the second row (M10, M11) of the matrix of all the quotients
+*	(starting as (0, 1)), which gives the coefficient of the original a in each number: a = M11 * a0 - M01 * b0, b = M00 * b0 - M10 * a0.
+*/
+static unsigned int ReduceGcdLimbs(std::vector<unsigned long long>& a, std::vector<unsigned long long>& b,
+	std::vector<unsigned long long>* cofactors)
+{
+	unsigned int size = EuclidStep(a, b, a.size(), cofactors); // makes the sizes close to each other
+	std::vector<unsigned long long> scratch;
+
+	while (size >= GCD_HALF_GCD_THRESHOLD) {
+		// The half-GCD of the higher 1/3 of the numbers reduces them by about 1/6 of their size
+		unsigned int p = 2 * size / 3;
+		GcdMatrix matrix;
+		unsigned int newSize = HalfGcd(a.data() + p, b.data() + p, size - p, matrix, scratch);
+		if (newSize > 0) {
+			size = AdjustByGcdMatrix(matrix, a.data(), b.data(), p, size);
+			if (cofactors != nullptr)
+				MultiplyGcdMatrixRow(cofactors, matrix);
+		}
+		else
+			size = EuclidStep(a, b, size, cofactors);
+		if (size == 0)
+			return 0;
+	}
+
+	while (size >= 2) {
+		unsigned long long mask = a[size - 1] | b[size - 1], ah, al, bh, bl;
+		unsigned int shift = CountLeadingZeros(mask);
+		ah = a[size - 1], al = a[size - 2], bh = b[size - 1], bl = b[size - 2];
+		if (shift != 0) {
+			unsigned long long aNext = size >= 3 ? a[size - 3] : 0, bNext = size >= 3 ? b[size - 3] : 0;
+			ah = (ah << shift) | (al >> (64 - shift));
+			al = (al << shift) | (aNext >> (64 - shift));
+			bh = (bh << shift) | (bl >> (64 - shift));
+			bl = (bl << shift) | (bNext >> (64 - shift));
+		}
+		unsigned long long lehmer[2][2];
+		if (LehmerMatrix(ah, al, bh, bl, lehmer)) {
+			scratch.resize(2 * size);
+			size = ApplyInverseMatrix1(lehmer, a.data(), b.data(), size, scratch.data());
+			if (cofactors != nullptr) {
+				GcdMatrix step;
+				for (unsigned int row = 0; row < 2; row++)
+					for (unsigned int column = 0; column < 2; column++)
+						step.elements[row][column].assign(1, lehmer[row][column]);
+				MultiplyGcdMatrixRow(cofactors, step);
+			}
+		}
+		else
+			size = EuclidStep(a, b, size, cofactors);
+	}
+	return size;
+}
+
+// Returns GCD(a, b), where both are not 0 (the vectors are changed)
+static std::vector<unsigned long long> GcdLimbs(std::vector<unsigned long long> a, std::vector<unsigned long long> b)
+{
+	unsigned int size = std::max(a.size(), b.size());
+	a.resize(size, 0);
+	b.resize(size, 0);
+	size = ReduceGcdLimbs(a, b, nullptr);
+
+	// Both numbers have a single limb now (or the GCD was found)
+	std::vector<unsigned long long> result(1, BinaryGcdOfLimbs(a[0], b[0]));
+	if (size != 1) {
+		// The smaller one became 0, the greater one is the GCD
+		result = NormalizedSize(a.data(), a.size()) > 0 ? a : b;
+		TrimLimbs(result);
+	}
+	return result;
+}
+
+/*	Returns GCD(a, b), where both are not 0, and its coefficient: GCD = x * a (mod b), where x = cofactor or x = -cofactor (if isNegative).
+*	Euclid's algorithm continues to the end (instead of the binary GCD), so the cofactors are kept for all the quotients.
+*/
+static std::vector<unsigned long long> ExtendedGcdLimbs(std::vector<unsigned long long> a, std::vector<unsigned long long> b,
+	std::vector<unsigned long long>& cofactor, bool& isNegative)
+{
+	unsigned int size = std::max(a.size(), b.size());
+	a.resize(size, 0);
+	b.resize(size, 0);
+	std::vector<unsigned long long> cofactors[2] = { { 0 }, { 1 } };
+	size = ReduceGcdLimbs(a, b, cofactors);
+	while (size > 0)
+		size = EuclidStep(a, b, size, cofactors);
+
+	// The GCD is the number that is not 0: a = M11 * a0 - M01 * b0, or b = M00 * b0 - M10 * a0
+	isNegative = NormalizedSize(a.data(), a.size()) == 0;
+	std::vector<unsigned long long> result = isNegative ? b : a;
+	TrimLimbs(result);
+	cofactor = cofactors[isNegative ? 0 : 1];
+	TrimLimbs(cofactor);
+	return result;
+}
+
+/*	Small primes:
+*	The odd primes below SIEVE_LIMIT are multiplied in groups that fit in 64 bits, so the remainder of a number by each product needs a single
+*	division for each limb, and the remainders by the primes of the group are found from it in 64-bit integers.
+*/
+struct SmallPrimeProduct
+{
+	unsigned long long divisor;		// the product shifted to be normalized
+	unsigned long long reciprocal;	// ReciprocalOfLimb(divisor)
+	unsigned int shift;
+	unsigned int first, last;		// the primes [first, last) of the table
+};
+
+struct SmallPrimeTable
+{
+	std::vector<unsigned int> primes;
+	std::vector<SmallPrimeProduct> products;
+	unsigned int trialProducts;		// the products of the primes below TRIAL_DIVISION_LIMIT (which come first)
+};
+
+static SmallPrimeTable BuildSmallPrimeTable()
+{
+	SmallPrimeTable table;
+	std::vector<bool> isComposite(SIEVE_LIMIT, false);
+	for (unsigned int i = 3; i < SIEVE_LIMIT; i += 2) {
+		if (isComposite[i])
+			continue;
+		table.primes.push_back(i);
+		for (unsigned int j = i * i; j < SIEVE_LIMIT; j += 2 * i)
+			isComposite[j] = true;
+	}
+
+	unsigned int i = 0;
+	table.trialProducts = 0;
+	while (i < table.primes.size()) {
+		SmallPrimeProduct product;
+		unsigned long long value = 1;
+		product.first = i;
+		// A group does not cross TRIAL_DIVISION_LIMIT, so the trial division can use the first products only
+		bool isTrial = table.primes[i] < TRIAL_DIVISION_LIMIT;
+		while (i < table.primes.size() && value <= ~0ULL / table.primes[i] && (table.primes[i] < TRIAL_DIVISION_LIMIT) == isTrial)
+			value *= table.primes[i++];
+		product.last = i;
+		product.shift = CountLeadingZeros(value);
+		product.divisor = value << product.shift;
+		product.reciprocal = ReciprocalOfLimb(product.divisor);
+		table.products.push_back(product);
+		if (isTrial)
+			table.trialProducts++;
+	}
+	return table;
+}
+
+static const SmallPrimeTable& GetSmallPrimeTable()
+{
+	static const SmallPrimeTable table = BuildSmallPrimeTable();
+	return table;
+}
+
+// remainders[k] = a mod (product k) for the first (count) products, in a single pass over the limbs (from the most significant).
+// Each remainder is kept shifted as in DivideLimbsBySingle, and the divisions by the different products are independent of each other.
+static void RemaindersBySmallPrimes(const unsigned long long* a, unsigned int size, const SmallPrimeProduct* products, unsigned int count,
+	unsigned long long* remainders)
+{
+	for (unsigned int k = 0; k < count; k++)
+		remainders[k] = products[k].shift == 0 ? 0 : a[size - 1] >> (64 - products[k].shift);
+	for (unsigned int i = size; i-- > 0; ) {
+		unsigned long long next = i > 0 ? a[i - 1] : 0;
+		for (unsigned int k = 0; k < count; k++) {
+			unsigned int shift = products[k].shift;
+			unsigned long long limb = shift == 0 ? a[i] : (a[i] << shift) | (next >> (64 - shift));
+			DivideWideByReciprocal(remainders[k], limb, products[k].divisor, products[k].reciprocal, remainders[k]);
+		}
+	}
+	for (unsigned int k = 0; k < count; k++)
+		remainders[k] >>= products[k].shift;
+}
+
+// The primes up to n (by the sieve of Eratosthenes on the odd numbers only)
+static std::vector<unsigned long long> PrimesUpTo(unsigned long long n)
+{
+	std::vector<unsigned long long> primes;
+	if (n < 2)
+		return primes;
+	primes.push_back(2);
+	std::vector<bool> isComposite(n / 2 + 1, false); // isComposite[i] is for 2i + 1
+	for (unsigned long long i = 1; 2 * i + 1 <= n; i++) {
+		if (isComposite[i])
+			continue;
+		unsigned long long p = 2 * i + 1;
+		primes.push_back(p);
+		for (unsigned long long j = p * p / 2; p <= n / p && 2 * j + 1 <= n; j += p)
+			isComposite[j] = true;
+	}
+	return primes;
+}
 
-	return *this;
+// The product of limbs[0 .. count) by a balanced tree: up to PRODUCT_TREE_LEAF limbs are multiplied one at a time (which is linear for each),
+// then the products of the two halves are multiplied, so the multiplications at each level have operands of about equal sizes
+static std::vector<unsigned long long> ProductTree(const unsigned long long* limbs, size_t count)
+{
+	if (count <= PRODUCT_TREE_LEAF) {
+		std::vector<unsigned long long> result(1, 1);
+		result.reserve(count + 1);
+		for (size_t i = 0; i < count; i++) {
+			unsigned long long carry = MultiplyRow(result.data(), result.data(), result.size(), limbs[i]);
+			if (carry)
+				result.push_back(carry);
+		}
+		return result;
+	}
+	size_t half = count / 2;
+	return MultiplyLimbVectors(ProductTree(limbs, half), ProductTree(limbs + half, count - half));
 }
 
-unsignedBigInteger& unsignedBigInteger::operator=(unsigned long long other)
+// The product of 64-bit factors, where consecutive factors are multiplied together first while their product fits in a single limb
+static std::vector<unsigned long long> ProductOfFactors(const std::vector<unsigned long long>& factors)
 {
-	Resize(1);
-	binaryContents[0] = other;
-	return *this;
+	std::vector<unsigned long long> limbs;
+	unsigned long long limb = 1;
+	for (unsigned long long factor : factors) {
+		unsigned long long high;
+		unsigned long long low = MultiplyWide(limb, factor, high);
+		if (high == 0)
+			limb = low;
+		else {
+			limbs.push_back(limb);
+			limb = factor;
+		}
+	}
+	limbs.push_back(limb);
+	std::vector<unsigned long long> result = ProductTree(limbs.data(), limbs.size());
+	TrimLimbs(result);
+	return result;
 }
 
-// This function accesses the binary contents by reference (easier code)
-inline unsigned long long& unsignedBigInteger::operator[](unsigned int binaryContentsIndex)
+/*	The odd part of n! by the prime swing (Luschny's algorithm): n! = (floor(n/2)!)^2 * swing(n), where swing(n) = n! / (floor(n/2)!)^2,
+*	and the exponent of each prime p in swing(n) is the number of odd values of floor(n / p^i) for i > 0, so it has no factors greater than n.
+*	The factors of 2 are left out (n! has n - popcount(n) of them). primes are the primes up to (at least) n.
+*/
+static std::vector<unsigned long long> OddFactorialLimbs(unsigned long long n, const std::vector<unsigned long long>& primes)
 {
-	return binaryContents[binaryContentsIndex];
+	if (n < 3)
+		return std::vector<unsigned long long>(1, 1);
+	std::vector<unsigned long long> half = OddFactorialLimbs(n / 2, primes), factors;
+	for (size_t i = 1; i < primes.size() && primes[i] <= n; i++) {
+		unsigned long long p = primes[i], quotient = n, factor = 1;
+		while (quotient >= p) {
+			quotient /= p;
+			if (quotient & 1)
+				factor *= p;
+		}
+		if (factor > 1)
+			factors.push_back(factor);
+	}
+	return MultiplyLimbVectors(MultiplyLimbVectors(half, half), ProductOfFactors(factors));
 }
 
 //=========================================================================================================================
 // Arithmatic Operators (+, -, *, /, %, +=, -=, *=, /=, %=, ++, --) and Arithmatic Functions:
-// 
+//
 // Each operator (other than ++, --) has 2 overloads, one with a big integer as an input and
 // the other one with a long long (64-bit int) as an input. This is also true for the following 
 // types of operators. (comparison, bitwise and shift)
@@ -91,120 +2848,90 @@ inline unsigned long long& unsignedBigInteger::operator[](unsigned int binaryCon
 
 // [TODO: Check the resulting size of each arithmatic operation beforehand, at least the addition, multiplication and FastPower function]
 
-unsignedBigInteger unsignedBigInteger::operator+(unsignedBigInteger& other)
+unsignedBigInteger unsignedBigInteger::operator+(const unsignedBigInteger& other) const&
 {
 	// These two pointers will point to (this) and (other) depending on how many elements are there in each of them (the size of binaryContents).
 	// The greaterNumber is not necessarily greater if they have the same number of elements, and it does not have to be.
-	unsignedBigInteger* greaterNumber;
-	unsignedBigInteger* smallerNumber;
-
-	unsigned int resultSize;
-	if (Size() >= other.Size()) {
-		resultSize = Size();
-		greaterNumber = this;
-		smallerNumber = &other;
-	}
-	else {
-		resultSize = other.Size();
-		greaterNumber = &other;
-		smallerNumber = this;
-	}
+	const unsignedBigInteger* greaterNumber = this;
+	const unsignedBigInteger* smallerNumber = &other;
+	if (Size() < other.Size())
+		std::swap(greaterNumber, smallerNumber);
 
-	// Construct a big integer with the maximum possible number of 64-bit elements:
+	// The result gets the size of the greater number even if it is above the maximum size of a new number
 	unsignedBigInteger result;
-	result.Resize(resultSize);
-	bool carry = 0;
-
-	// Add all the elements up to the size of the smaller number.
-	for (unsigned int i = 0; i < smallerNumber->Size(); i++) {
-		result[i] = (*greaterNumber)[i] + (*smallerNumber)[i] + carry;
-		// if the current element of the result is strictly smaller than any of the 2 inputs',
-		// then an overflow has occurred and a carry is added to the next element.
-		carry = result[i] < (*greaterNumber)[i] || result[i] < (*smallerNumber)[i] ||
-			(result[i] == (*greaterNumber)[i] && carry); // <- This condition is a special case [0xFF + 0xFF + (carry=1) = 0x1FF]
-	}
-	
-	// Add the rest of the elements of the greater number. Keep adding the carry along (e.g. 1+2999 = 3000)
-	for (unsigned int i = smallerNumber->Size(); i < greaterNumber->Size(); i++) {
-		result[i] = (*greaterNumber)[i] + carry;
-		if (result[i] != 0)
-			carry = 0;
-	}
+	result.isConvertedToDecimal = false;
+	result.Resize(greaterNumber->Size(), true);
+	unsigned long long carry = AddLimbs(result.binaryContents.data(), greaterNumber->binaryContents.data(), greaterNumber->Size(),
+		smallerNumber->binaryContents.data(), smallerNumber->Size());
 
 	// Check if the last calculation had a carry
-	if (carry)
-		result.binaryContents.push_back(carry);
+	if (carry) {
+		if (!result.Resize(result.Size() + 1, true)) {
+			printf("DEBUG: An error occurred during addition: The result exceeds the absolute maximum size!\n");
+			return unsignedBigInteger(0);
+		}
+		result.binaryContents.back() = carry;
+	}
 
 	return result;
 }
 
-unsignedBigInteger unsignedBigInteger::operator-(unsignedBigInteger& other)
+unsignedBigInteger unsignedBigInteger::operator+(const unsignedBigInteger& other) &&
+{
+	// (*this) is a temporary, so the result is calculated in its contents
+	return std::move((*this) += other);
+}
+
+unsignedBigInteger unsignedBigInteger::operator+(unsignedBigInteger&& other) const&
+{
+	// (other) is a temporary, so the result is calculated in its contents (the operation is commutative)
+	return std::move(other += (*this));
+}
+
+unsignedBigInteger unsignedBigInteger::operator+(unsignedBigInteger&& other) &&
+{
+	return std::move((*this) += other);
+}
+
+unsignedBigInteger unsignedBigInteger::operator-(const unsignedBigInteger& other) const&
 {
 	if ((*this) < other)
 		return unsignedBigInteger(0); // no negative values are allowed.
 
 	unsignedBigInteger result;
-	result.Resize(Size());
-	bool borrow = 0;
-	for (unsigned int i = 0; i < other.Size(); i++) {
-		result[i] = binaryContents[i] - other[i] - borrow;
-		// if the current element of the result is strictly greater than binaryContents[i], or equal and the borrow is 1,
-		// then an overflow has occurred and a borrow is subtracted from the next element.
-		borrow = result[i] > binaryContents[i] ||
-			(result[i] == binaryContents[i] && borrow); // e.g. [0xYZ - 0xFF - (borrow=1) = 0xYZ] (mod 256)
-	}
-
-	for (unsigned int i = other.Size(); i < Size(); i++) {
-		result[i] = binaryContents[i] - borrow;
-		if (binaryContents[i] != 0)
-			borrow = 0;
-	}
-
-	// Check if the last calculation had a borrow
-	if (borrow) {
-		// This means that the subtraction of the last element is negative, so the (other) is less than (this) and the result should be 0 from the start.
-		printf("DEBUG: An error occurred in the last transaction!\n");
-		result = 0;
-	}
+	result.isConvertedToDecimal = false;
+	result.Resize(Size(), true);
+	// No borrow is left, since (*this) >= other
+	SubtractLimbs(result.binaryContents.data(), binaryContents.data(), Size(), other.binaryContents.data(), other.Size());
 	result.ShrinkContents();
 	return result;
 }
 
-unsignedBigInteger unsignedBigInteger::operator*(unsignedBigInteger& other)
+unsignedBigInteger unsignedBigInteger::operator-(const unsignedBigInteger& other) &&
 {
-	if (other == 0)
-		return unsignedBigInteger(0);
+	// (*this) is a temporary, so the result is calculated in its contents
+	return std::move((*this) -= other);
+}
 
-	// Each element of these vectors contains a 32-bit integer in a 64-bit container to avoid overflowing (including answer)
-	std::vector<unsigned long long> firstNumber = GetExpandedContents(),
-		secondNumber = other.GetExpandedContents(),
-		answer;
-
-	unsigned int answerSize = firstNumber.size() + secondNumber.size() + 1;
-	answerSize += answerSize & 1; // make it even
-	answer.resize(answerSize);
-
-	for (unsigned int idx = 0; idx < answerSize - 1; idx++) {
-		for (int i = std::min(idx, (unsigned int)(firstNumber.size() - 1)), j = idx - i;
-			(i >= 0) && (j < secondNumber.size()); i--, j++) {
-			unsigned long long multiply = firstNumber[i] * secondNumber[j];
-			answer[idx] += multiply;
-			if (answer[idx] < multiply) // overflow occurs from 64-bit (add to idx+2)
-				answer[idx + 2]++;
-		}
-		answer[idx + 1] += (answer[idx] & HIGH_DWORD) >> 32; // total overflow occurred from 32-bit (add to idx+1)
-		answer[idx] &= LOW_DWORD;
-	}
+unsignedBigInteger unsignedBigInteger::operator*(const unsignedBigInteger& other) const
+{
+	if (other == 0 || (*this) == 0)
+		return unsignedBigInteger(0);
 
+	// The algorithm (schoolbook, Karatsuba, Toom-3 or NTT) is selected by MultiplyLimbs depending on the sizes,
+	// and the squaring version is used if both inputs are the same number (such as in [x * x] or [x *= x])
 	unsignedBigInteger result;
-	result.Resize(answerSize >> 1);
-	for (unsigned int i = 0, j = 0; i < result.Size(); i++, j += 2)
-		result[i] = answer[j] | (answer[j + 1] << 32); // combine answer
+	result.isConvertedToDecimal = false;
+	if (!result.Resize(Size() + other.Size(), true)) {
+		printf("DEBUG: An error occurred during multiplication: The result exceeds the absolute maximum size!\n");
+		return unsignedBigInteger(0);
+	}
+	MultiplyLimbs(binaryContents.data(), Size(), other.binaryContents.data(), other.Size(), result.binaryContents.data());
 	result.ShrinkContents();
 	return result;
 }
 
-unsignedBigInteger unsignedBigInteger::operator/(unsignedBigInteger& other)
+unsignedBigInteger unsignedBigInteger::operator/(const unsignedBigInteger& other) const
 {
 	unsignedBigInteger quotient, remainder;
 	if (Divide(*this, other, quotient, remainder))
@@ -213,7 +2940,7 @@ unsignedBigInteger unsignedBigInteger::operator/(unsignedBigInteger& other)
 	return unsignedBigInteger(0);
 }
 
-unsignedBigInteger unsignedBigInteger::operator%(unsignedBigInteger& other)
+unsignedBigInteger unsignedBigInteger::operator%(const unsignedBigInteger& other) const
 {
 	unsignedBigInteger quotient, remainder;
 	if (Divide(*this, other, quotient, remainder))
@@ -222,153 +2949,131 @@ unsignedBigInteger unsignedBigInteger::operator%(unsignedBigInteger& other)
 	return unsignedBigInteger(0);
 }
 
-unsignedBigInteger unsignedBigInteger::operator+(unsigned long long other)
+unsignedBigInteger unsignedBigInteger::operator+(unsigned long long other) const&
 {
-	unsignedBigInteger result(*this);
-	result[0] += other;
-	if (result[0] >= other)
-		return result; // no carry
-
-	// loop for the carry:
-	for (unsigned int i = 1; i < result.Size(); i++)
-		if (++result[i] != 0)
-			break;
-
-	if (result.binaryContents.back() == 0)
-		result.binaryContents.push_back(1);
+	unsignedBigInteger result;
+	result.isConvertedToDecimal = false;
+	result.Resize(Size(), true);
+	unsigned long long carry = AddLimb(result.binaryContents.data(), binaryContents.data(), Size(), other);
+	if (carry) {
+		if (!result.Resize(result.Size() + 1, true)) {
+			printf("DEBUG: An error occurred during addition: The result exceeds the absolute maximum size!\n");
+			return unsignedBigInteger(0);
+		}
+		result.binaryContents.back() = carry;
+	}
 	return result;
 }
 
-unsignedBigInteger unsignedBigInteger::operator-(unsigned long long other)
+unsignedBigInteger unsignedBigInteger::operator+(unsigned long long other) &&
+{
+	// (*this) is a temporary, so the result is calculated in its contents
+	return std::move((*this) += other);
+}
+
+unsignedBigInteger unsignedBigInteger::operator-(unsigned long long other) const&
 {
 	if (Size() == 1 && binaryContents[0] <= other)
 		return unsignedBigInteger(0); // no negative values are allowed.
 
-	unsignedBigInteger result(*this);
-	result[0] -= other;
-	if (result[0] <= binaryContents[0])
-		return result; // no borrow
+	unsignedBigInteger result;
+	result.isConvertedToDecimal = false;
+	result.Resize(Size(), true);
+	SubtractLimb(result.binaryContents.data(), binaryContents.data(), Size(), other);
+	result.ShrinkContents();
+	return result;
+}
 
-	// loop for the borrow:
-	for (unsigned int i = 1; i < result.Size(); i++)
-		if (result[i]-- != 0)
-			break;
+unsignedBigInteger unsignedBigInteger::operator-(unsigned long long other) &&
+{
+	// (*this) is a temporary, so the result is calculated in its contents
+	return std::move((*this) -= other);
+}
 
-	result.ShrinkContents();
+unsignedBigInteger unsignedBigInteger::operator*(unsigned long long other) const&
+{
+	unsignedBigInteger result(*this);
+	result *= other;
 	return result;
 }
 
-unsignedBigInteger unsignedBigInteger::operator*(unsigned long long other)
+unsignedBigInteger unsignedBigInteger::operator*(unsigned long long other) &&
 {
-	// other is casted to unsignedBigInteger to avoid copying the code
-	unsignedBigInteger otherNumber(other);
-	return (*this) * otherNumber;
+	// (*this) is a temporary, so the result is calculated in its contents
+	return std::move((*this) *= other);
 }
 
-unsignedBigInteger unsignedBigInteger::operator/(unsigned long long other)
+unsignedBigInteger unsignedBigInteger::operator/(unsigned long long other) const&
 {
 	unsignedBigInteger quotient;
-	if ((other & HIGH_DWORD) == 0) { // check if other fits in 32-bit integer
-		unsigned int divisor = other, remainder;
-		if (Divide(*this, divisor, quotient, remainder))
-			return quotient;
-		// If unsuccessful
-		return unsignedBigInteger(0);
-	}
-
-	unsignedBigInteger divisor(other), remainder;
-	if (Divide(*this, divisor, quotient, remainder))
+	unsigned long long remainder;
+	if (Divide(*this, other, quotient, remainder))
 		return quotient;
 	// If unsuccessful
 	return unsignedBigInteger(0);
 }
 
-unsignedBigInteger unsignedBigInteger::operator%(unsigned long long other)
+unsignedBigInteger unsignedBigInteger::operator/(unsigned long long other) &&
 {
-	unsignedBigInteger dividend(*this), quotient;
-	if ((other & HIGH_DWORD) == 0) { // check if other fits in 32-bit integer
-		unsigned int divisor = other, remainder;
-		if (Divide(*this, divisor, quotient, remainder))
-			return unsignedBigInteger(remainder);
-		// If unsuccessful
-		return unsignedBigInteger(0);
-	}
+	// (*this) is a temporary, so the result is calculated in its contents
+	return std::move((*this) /= other);
+}
 
-	unsignedBigInteger divisor(other), remainder;
-	if (Divide(*this, divisor, quotient, remainder))
-		return remainder;
+unsignedBigInteger unsignedBigInteger::operator%(unsigned long long other) const
+{
+	unsignedBigInteger quotient;
+	unsigned long long remainder;
+	if (Divide(*this, other, quotient, remainder))
+		return unsignedBigInteger(remainder);
 	// If unsuccessful
 	return unsignedBigInteger(0);
 }
 
-unsignedBigInteger& unsignedBigInteger::operator+=(unsignedBigInteger& other)
+unsignedBigInteger unsignedBigInteger::operator%(const barrettReducer& reducer) const
 {
-	if (Size() < other.Size())
-		this->Resize(other.Size());
-	
-	// Construct a big integer with the maximum possible number of 64-bit elements:
-	bool carry = 0;
+	return reducer.Reduce(*this);
+}
 
-	// Add all the elements up to the size of other.
-	for (unsigned int i = 0; i < other.Size(); i++) {
-		binaryContents[i] += other[i] + carry;
-		// if the current element of the result is strictly smaller than any of the 2 inputs', then an overflow has occurred and a carry is added to the next element.
-		carry = binaryContents[i] < other[i] || binaryContents[i] < carry || 
-			(binaryContents[i] == other[i] && carry); // This is a special case [e.g. 0xFF + 0xFF + (carry=1) = 0x1FF]
-	}
+unsignedBigInteger& unsignedBigInteger::operator+=(const unsignedBigInteger& other)
+{
+	isConvertedToDecimal = false; // decimalContents will not represent the new value
+	if (Size() < other.Size())
+		this->Resize(other.Size(), true);
 
-	// Add the rest of the elements of the greater number. Keep adding the carry along [e.g. 1+2999 = 3000]
-	for (unsigned int i = other.Size(); i < this->Size() && carry; i++)
-		if (++binaryContents[i] != 0)
-			carry = 0;
+	// In-place, which also works for (x += x), since each element is read before it is written
+	unsigned long long carry = AddLimbs(binaryContents.data(), binaryContents.data(), Size(), other.binaryContents.data(), other.Size());
 
 	// Check if the last calculation had a carry
-	if (carry)
-		binaryContents.push_back(carry);
+	if (carry) {
+		if (!Resize(Size() + 1, true)) {
+			printf("DEBUG: An error occurred during addition: The result exceeds the absolute maximum size!\n");
+			return (*this) = 0;
+		}
+		binaryContents.back() = carry;
+	}
 
 	return (*this);
 }
 
-unsignedBigInteger& unsignedBigInteger::operator-=(unsignedBigInteger& other)
+unsignedBigInteger& unsignedBigInteger::operator-=(const unsignedBigInteger& other)
 {
+	isConvertedToDecimal = false; // decimalContents will not represent the new value
 	if ((*this) < other)
 		return (*this) = 0;
-	
-	bool borrow = 0;
-	unsigned long long beforeSubtraction;
-	for (unsigned int i = 0; i < other.Size(); i++) {
-		beforeSubtraction = binaryContents[i];
-		binaryContents[i] -= other[i] + borrow;
-
-		// if the current element of the result is strictly greater than "beforeSubtraction", or equal and the borrow is 1, then an overflow has occurred and a borrow is subtracted from the next element.
-		borrow = binaryContents[i] > beforeSubtraction ||
-			(binaryContents[i] == beforeSubtraction && borrow); // e.g. [0xYZ - 0xFF - (borrow=1) = 0xYZ] (mod 256)
-	}
-
-	// Keep the rest of the elements unless there is a need to keep subtracting the carry along (e.g. 3000 - 1 = 2999)
-	for (unsigned int i = other.Size(); i < Size() && borrow; i++)
-		if (binaryContents[i]-- != 0)
-			borrow = 0;
-
-
-	// Check if the last calculation had a borrow
-	if (borrow) {
-		// This means that the subtraction of the last element is negative, so the (other) is less than (this) and the result should be 0 from the start.
-		printf("DEBUG: An error occurred in the last subtraction!\n");
-		(*this) = 0;
-	}
 
+	// No borrow is left, since (*this) >= other
+	SubtractLimbs(binaryContents.data(), binaryContents.data(), Size(), other.binaryContents.data(), other.Size());
 	ShrinkContents();
 	return (*this);
 }
 
-unsignedBigInteger& unsignedBigInteger::operator*=(unsignedBigInteger& other)
+unsignedBigInteger& unsignedBigInteger::operator*=(const unsignedBigInteger& other)
 {
-	unsignedBigInteger firstNumber(*this);
-	return (*this) = firstNumber * other;
+	// The product is built in a new number, so (other) may be (*this) itself
+	return (*this) = (*this) * other;
 }
 
-unsignedBigInteger& unsignedBigInteger::operator/=(unsignedBigInteger& other)
+unsignedBigInteger& unsignedBigInteger::operator/=(const unsignedBigInteger& other)
 {
 	unsignedBigInteger dividend(*this), remainder;
 	if (Divide(dividend, other, *this, remainder)) // *this as quotient
@@ -377,7 +3082,7 @@ unsignedBigInteger& unsignedBigInteger::operator/=(unsignedBigInteger& other)
 	return (*this) = 0;
 }
 
-unsignedBigInteger& unsignedBigInteger::operator%=(unsignedBigInteger& other)
+unsignedBigInteger& unsignedBigInteger::operator%=(const unsignedBigInteger& other)
 {
 	unsignedBigInteger dividend(*this), quotient;
 	if (Divide(dividend, other, quotient, *this)) // *this as remainder
@@ -388,60 +3093,49 @@ unsignedBigInteger& unsignedBigInteger::operator%=(unsignedBigInteger& other)
 
 unsignedBigInteger& unsignedBigInteger::operator+=(unsigned long long other)
 {
-	binaryContents[0] += other;
-	if (binaryContents[0] >= other)
-		return (*this); // no carry
-
-	// loop for the carry:
-	for (unsigned int i = 1; i < Size(); i++)
-		if (++binaryContents[i] != 0)
-			break;
-
-	if (binaryContents.back() == 0)
-		binaryContents.push_back(1);
+	isConvertedToDecimal = false; // decimalContents will not represent the new value
+	unsigned long long carry = AddLimb(binaryContents.data(), binaryContents.data(), Size(), other);
+	if (carry) {
+		if (!Resize(Size() + 1, true)) {
+			printf("DEBUG: An error occurred during addition: The result exceeds the absolute maximum size!\n");
+			return (*this) = 0;
+		}
+		binaryContents.back() = carry;
+	}
 	return (*this);
 }
 
 unsignedBigInteger& unsignedBigInteger::operator-=(unsigned long long other)
 {
-	unsigned long long beforeSubtraction = binaryContents[0];
-	binaryContents[0] -= other;
-	if (Size() == 1 && binaryContents[0] > beforeSubtraction)
+	isConvertedToDecimal = false; // decimalContents will not represent the new value
+	if (Size() == 1 && binaryContents[0] < other)
 		return (*this) = 0; // no negative values are allowed.
 
-	if (binaryContents[0] <= beforeSubtraction)
-		return (*this); // no borrow
-
-	// loop for the borrow:
-	for (unsigned int i = 1; i < Size(); i++)
-		if (binaryContents[i]-- != 0)
-			break;
-
+	SubtractLimb(binaryContents.data(), binaryContents.data(), Size(), other);
 	ShrinkContents();
 	return (*this);
-
 }
 
 unsignedBigInteger& unsignedBigInteger::operator*=(unsigned long long other)
 {
-	// other is casted to unsignedBigInteger to avoid copying the code
-	unsignedBigInteger firstNumber(*this), otherNumber(other);
-	return (*this) = firstNumber * otherNumber;
+	isConvertedToDecimal = false; // decimalContents will not represent the new value
+	// Each element is multiplied in-place, and only the last carry may need a new element
+	unsigned long long carry = MultiplyRow(binaryContents.data(), binaryContents.data(), Size(), other);
+	if (carry != 0) {
+		if (!Resize(Size() + 1, true)) {
+			printf("DEBUG: An error occurred during multiplication: The result exceeds the absolute maximum size!\n");
+			return (*this) = 0;
+		}
+		binaryContents.back() = carry;
+	}
+	ShrinkContents(); // in case of multiplying by 0
+	return (*this);
 }
 
 unsignedBigInteger& unsignedBigInteger::operator/=(unsigned long long other)
 {
-	unsignedBigInteger dividend(*this);
-	if ((other & HIGH_DWORD) == 0) { // check if other fits in 32-bit integer
-		unsigned int divisor = other, remainder;
-		if (Divide(dividend, divisor, *this, remainder)) // *this as quotient
-			return *this;
-		// If unsuccessful
-		return (*this) = 0;
-	}
-
-	unsignedBigInteger divisor(other), remainder;
-	if (Divide(dividend, divisor, *this, remainder)) // *this as quotient
+	unsigned long long remainder;
+	if (Divide(*this, other, *this, remainder)) // *this as both dividend and quotient (divided in-place)
 		return *this;
 	// If unsuccessful
 	return (*this) = 0;
@@ -449,22 +3143,19 @@ unsignedBigInteger& unsignedBigInteger::operator/=(unsigned long long other)
 
 unsignedBigInteger& unsignedBigInteger::operator%=(unsigned long long other)
 {
-	unsignedBigInteger dividend(*this), quotient;
-	if ((other & HIGH_DWORD) == 0) { // check if other fits in 32-bit integer
-		unsigned int divisor = other, remainder;
-		if (Divide(dividend, divisor, quotient, remainder))
-			return (*this) = remainder;
-		// If unsuccessful
-		return (*this) = 0;
-	}
-
-	unsignedBigInteger divisor(other);
-	if (Divide(dividend, divisor, quotient, *this)) // *this as remainder
-		return *this;
+	unsignedBigInteger quotient;
+	unsigned long long remainder;
+	if (Divide(*this, other, quotient, remainder))
+		return (*this) = remainder;
 	// If unsuccessful
 	return (*this) = 0;
 }
 
+unsignedBigInteger& unsignedBigInteger::operator%=(const barrettReducer& reducer)
+{
+	return (*this) = reducer.Reduce(*this);
+}
+
 unsignedBigInteger& unsignedBigInteger::operator++()
 {
 	return (*this) += 1;
@@ -475,7 +3166,7 @@ unsignedBigInteger& unsignedBigInteger::operator--()
 	return (*this) -= 1;
 }
 
-bool Divide(unsignedBigInteger& dividend, unsignedBigInteger& divisor,
+bool Divide(const unsignedBigInteger& dividend, const unsignedBigInteger& divisor,
 	unsignedBigInteger& quotient, unsignedBigInteger& remainder)
 {
 	// Inputs:	dividend, divisor
@@ -493,48 +3184,48 @@ bool Divide(unsignedBigInteger& dividend, unsignedBigInteger& divisor,
 		return true;
 	}
 
-	if (divisor <= LOW_DWORD) { // Check if divisor fits in 32-bit integer
-		unsigned int divisorInt = divisor.ToUInt(), remainderInt = remainder.ToUInt();
-		if (Divide(dividend, divisorInt, quotient, remainderInt)) {
-			remainder = remainderInt;
-			return true;
-		}
-		return false;
-	}
-
-	quotient = 0;
-	unsigned int shift = dividend.NumberOfBits() - divisor.NumberOfBits();
-	unsignedBigInteger shifted = divisor << shift;
-	unsignedBigInteger product = 0;
-	
-	// while (shifted >= divisor) { // replaced with the break at the end
-	
-	while(true) {
-		quotient <<= 1;
-		if (product + shifted <= dividend) {
-			product += shifted;
-			quotient |= 1;
-		}
-		shifted >>= 1;
-		if (shift-- == 0)
-			break;
+	// A divisor of a single element is divided directly into the contents of the quotient (see the 64-bit version)
+	// It is copied first as the quotient or remainder may be the same object as the divisor, such as in [x /= x]
+	if (divisor.Size() == 1) {
+		unsigned long long divisor64 = divisor.binaryContents[0], remainder64;
+		Divide(dividend, divisor64, quotient, remainder64);
+		remainder = remainder64;
+		return true;
 	}
 
-	remainder = dividend - product;
-
-	if (remainder >= divisor) {
-		printf("DEBUG: An error occurred during division!: The remainder is greator than the divisor!\n");
-		return false;
+	// Both numbers are kept without leading zero elements by all operations, and the outputs are only written at the end
+	// (quotient or remainder may be the same object as the divisor, such as in [x /= x])
+	unsigned int dividendSize = dividend.Size(), divisorSize = divisor.Size(), quotientSize = dividendSize - divisorSize + 1;
+	if (divisorSize < BURNIKEL_ZIEGLER_THRESHOLD || quotientSize < BURNIKEL_ZIEGLER_THRESHOLD) {
+		// Knuth's Algorithm D directly on the contents (the same choice as DivideLimbVectors, without copying to other vectors)
+		limbVector quotientContents, remainderContents;
+		quotientContents.resize(quotientSize);
+		remainderContents.resize(divisorSize);
+		DivideLimbs(dividend.binaryContents.data(), dividendSize, divisor.binaryContents.data(), divisorSize,
+			quotientContents.data(), remainderContents.data());
+		quotient.binaryContents.swap(quotientContents);
+		remainder.binaryContents.swap(remainderContents);
 	}
-	if (quotient * divisor != product) {
-		printf("DEBUG: An error occurred during division!: The product does not equal the multiplication of the quotient and the divisor!\n");
-		return false;
+	else {
+		// The algorithm (Burnikel-Ziegler or Newton's reciprocal) is selected by DivideLimbVectors depending on the sizes
+		std::vector<unsigned long long> dividendContents(dividend.binaryContents.begin(), dividend.binaryContents.end()),
+			divisorContents(divisor.binaryContents.begin(), divisor.binaryContents.end()), quotientContents, remainderContents;
+		DivideLimbVectors(dividendContents, divisorContents, quotientContents, remainderContents);
+		quotient.binaryContents.assign(quotientContents.data(), quotientContents.size());
+		remainder.binaryContents.assign(remainderContents.data(), remainderContents.size());
 	}
+	// The contents were installed directly, so the maximum sizes are extended to them (no elements are added or removed)
+	quotient.Resize(quotient.Size(), true);
+	remainder.Resize(remainder.Size(), true);
+	quotient.isConvertedToDecimal = false;
+	remainder.isConvertedToDecimal = false;
+	quotient.ShrinkContents();
+	remainder.ShrinkContents();
 	return true;
 }
 
-bool Divide(unsignedBigInteger& dividend, unsigned int& divisor,
-	unsignedBigInteger& quotient, unsigned int& remainder) 
+bool Divide(const unsignedBigInteger& dividend, const unsigned long long& divisor,
+	unsignedBigInteger& quotient, unsigned long long& remainder)
 {
 	// Inputs:	dividend, divisor
 	// Outputs: quotient, remainder
@@ -545,98 +3236,352 @@ bool Divide(unsignedBigInteger& dividend, unsigned int& divisor,
 		return false;
 	}
 
-	if (dividend < divisor) {
-		remainder = dividend.ToULongLong();
-		quotient = 0;
-		return true;
+	/*	Each 64-bit element of the dividend is divided (starting from the most significant) together with the remainder
+	*	of the previous one, which is a 128-bit by 64-bit division where the quotient fits in 64 bits.
+	*	These divisions use a reciprocal of the divisor which is computed once (see DivideLimbsBySingle),
+	*	so the whole operation is done in a single linear pass. quotient may be the same object as the dividend.
+	*/
+	unsigned int size = dividend.Size();
+	if (&quotient != &dividend)
+		quotient.Resize(size, true);
+	remainder = DivideLimbsBySingle(quotient.binaryContents.data(), dividend.binaryContents.data(), size, divisor);
+	quotient.isConvertedToDecimal = false;
+	quotient.ShrinkContents();
+	return true;
+}
+
+bool Divide(const unsignedBigInteger& dividend, const unsigned int& divisor,
+	unsignedBigInteger& quotient, unsigned int& remainder) 
+{
+	// The 64-bit version does the work, and the remainder is smaller than the divisor, so it fits in 32 bits
+	unsigned long long divisor64 = divisor, remainder64;
+	if (!Divide(dividend, divisor64, quotient, remainder64))
+		return false;
+	remainder = (unsigned int) remainder64;
+	return true;
+}
+
+unsignedBigInteger& unsignedBigInteger::FastPower(unsigned long long exponent)
+{
+	if (exponent == 0) {
+		*this = 1;
+		return *this;
 	}
+	
+	if ((*this) == 0)
+		return (*this);
 
-	quotient = 0;
-	unsigned long long packet = 1LL << 32, // Equivalent to 2^32
-		packetQuotient, packetRemainder,
-		remainder64 = 0; // 64-bit place holder to avoid overflow
-
-	unsignedBigInteger Temp;
-	packetQuotient = packet / divisor;
-	packetRemainder = packet % divisor;
-
-	/*	Let D = (A * B) / C where A = Na * C + Ra, B = Nb * C + Rb
-	*	Then D = Na * Nb * C + Na * Rb + Nb * Ra + (Ra * Rb) / C
-	*	
-	*	Where:
-	*	- A is explained below
-	*	- B is the packet (2^32)
-	*	- C is the divisor
-	*	- D is the quotient
-	* 
-	*	The dividend is represented by elements of 64-bit integers, where each element is divided into two 32-bit integers below
-	*	Let each element of these be represented by E_i starting from E_0 as the least significant element and ending at E_(n-1)
-	*	Then the dividend can be represented by the following equation
-	*	dividend = E_0 * packet^0 + E_1 * packet^1 + E_2 * packet^2 + ... + E_(n-1) * packet^(n-1)
-	*			 = E_0 + packet * (E_1 + packet * ( ... (E_(n-2) + packet * E_(n-1)) ... ))
-	* 
-	*	So the A terms described above will contain the following elements at each step, where B = packet at all of them
-	*	A_0 = E_(n-1)
-	*	A_1 = E_(n-2) + packet * E_(n-1) = E_(n-2) + packet * A_0
-	*	...
-	*	A_i = E_(n-1-i) + packet * A_(i-1)
-	*	
-	*/
+	// [TODO: Check the expected size first]
 
-	for (unsigned int i = dividend.Size() - 1; ; i--) {
-		unsigned long long A[2] = { (dividend[i] & HIGH_DWORD) >> 32, dividend[i] & LOW_DWORD };
-		for (unsigned int j = 0; j < 2; j++) {
-			quotient += A[j] / divisor;
-			remainder64 += A[j] % divisor;
-			quotient += remainder64 / divisor;
-			remainder64 %= divisor;
-			
-			if (i == 0 && j == 1) // to avoid multiplying the last element by packet
-				break;
+	unsignedBigInteger base(*this);
+	exponent--; // (*this) already contains the first power
+
+	while (exponent > 0) {
+		if ((exponent & 1) == 1)
+			(*this) *= base;
+		exponent >>= 1;
+		if (exponent > 0) // the last square is not needed
+			base.Square();
+	}
+	return (*this);
+}
+
+unsignedBigInteger& unsignedBigInteger::Square()
+{
+	isConvertedToDecimal = false; // decimalContents will not represent the new value
+	if ((*this) == 0)
+		return (*this);
+
+	// The algorithm is selected by SquareLimbs depending on the size (like MultiplyLimbs), then the result is moved into (*this)
+	unsignedBigInteger result;
+	result.isConvertedToDecimal = false;
+	if (!result.Resize(2 * Size(), true)) {
+		printf("DEBUG: An error occurred during multiplication: The result exceeds the absolute maximum size!\n");
+		return (*this) = 0;
+	}
+	SquareLimbs(binaryContents.data(), Size(), result.binaryContents.data());
+	result.ShrinkContents();
+	return (*this) = std::move(result);
+}
+
+// Returns whether base^k > n (without overflowing)
+static bool PowerOfLimbExceeds(unsigned long long base, unsigned long long k, unsigned long long n)
+{
+	unsigned long long power = 1;
+	for (unsigned long long i = 0; i < k && base > 1; i++) {
+		unsigned long long high;
+		power = MultiplyWide(power, base, high);
+		if (high != 0 || power > n)
+			return true;
+	}
+	return base == 0 ? false : power > n;
+}
 
-			Temp = quotient * packetQuotient;
-			Temp *= divisor;
+// floor(n^(1/k)) for a 64-bit n: the estimate of the floating point power is corrected by a few steps
+static unsigned long long RootOfLimb(unsigned long long n, unsigned long long k)
+{
+	unsigned long long root = (unsigned long long)std::pow((long double)n, 1.0L / k);
+	while (root > 0 && PowerOfLimbExceeds(root, k, n))
+		root--;
+	while (!PowerOfLimbExceeds(root + 1, k, n))
+		root++;
+	return root;
+}
 
-			quotient *= packetRemainder;
-			quotient += remainder64 * packetQuotient;
-			quotient += Temp;
-			
-			remainder64 *= packetRemainder;
-			quotient += remainder64 / divisor;
-			remainder64 %= divisor;
+/*	floor(n^(1/k)) for k >= 2 and n > 0, where the precision is doubled at each level:
+*	The root of the higher bits (n >> k*s) is found recursively (with about half of the bits of the root), then it is shifted by s bits
+*	(so it is less than the root by less than 2^(s+1)), and a single Newton step at the full size makes the error about a unit.
+*	Small roots (from the number of bits of n) are found bit by bit instead, and the roots of 64-bit numbers directly.
+*/
+unsignedBigInteger unsignedBigInteger::IntegerRoot(unsignedBigInteger& n, unsigned long long k)
+{
+	unsigned long long rootBits = (n.NumberOfBits() - 1ULL) / k + 1, kBits = 64 - CountLeadingZeros(k);
+	signed long long shift = ((signed long long)rootBits - (signed long long)kBits - 4) / 2;
+	unsignedBigInteger root(0), power;
+	if (n.Size() == 1)
+		return unsignedBigInteger(RootOfLimb(n.ToULongLong(), k));
+	if (rootBits <= 32 || shift < 1) {
+		for (unsigned long long bit = rootBits; bit-- > 0; ) {
+			unsignedBigInteger candidate = root + (unsignedBigInteger(1) << bit);
+			power = candidate;
+			if (power.FastPower(k) <= n)
+				root = std::move(candidate);
 		}
-		if (i == 0)
-			break;
+		return root;
 	}
-	remainder = (unsigned int) remainder64;
-	return true;
+
+	unsignedBigInteger high = n >> (k * shift);
+	root = IntegerRoot(high, k);
+	// The shifted root may exceed the maximum size (like n), so it is extended first (the zero elements are removed again)
+	if (!root.Resize(root.Size() + shift / 64 + 1, true))
+		return unsignedBigInteger(0);
+	root.ShrinkContents();
+	root <<= shift;
+
+	/*	Newton's step x = ((k - 1) * x + n / x^(k - 1)) / k is never less than the root (by the AM-GM inequality), and it is less than x
+	*	whenever x is greater than the root, so the steps are repeated until they stop decreasing (after one or two steps from the estimate)
+	*/
+	for (bool isFirstStep = true; ; isFirstStep = false) {
+		power = root;
+		power.FastPower(k - 1);
+		unsignedBigInteger next = (root * (k - 1) + n / power) / k;
+		if (!isFirstStep && next >= root)
+			return root;
+		root = std::move(next);
+	}
+}
+
+unsignedBigInteger& unsignedBigInteger::SquareRoot()
+{
+	return Root(2);
+}
+
+unsignedBigInteger& unsignedBigInteger::Root(unsigned long long k)
+{
+	isConvertedToDecimal = false; // decimalContents will not represent the new value
+	if (k == 0) {
+		printf("DEBUG: An error occurred while calculating the root: The 0th root is not defined!\n");
+		return (*this) = 0;
+	}
+	if (k == 1 || (*this) == 0)
+		return (*this);
+	return (*this) = IntegerRoot(*this, k);
+}
+
+unsignedBigInteger GCD(const unsignedBigInteger& a, const unsignedBigInteger& b)
+{
+	if (a == 0)
+		return b;
+	if (b == 0)
+		return a;
+
+	// Binary part: GCD(a, b) = 2^min(i, j) * GCD(a / 2^i, b / 2^j), where 2^i and 2^j are the greatest powers of 2 that divide a and b
+	unsigned long long aZeros = 0, bZeros = 0;
+	unsigned int index = 0;
+	while (a.binaryContents[index] == 0)
+		index++;
+	aZeros = index * 64ULL + CountTrailingZeros(a.binaryContents[index]);
+	index = 0;
+	while (b.binaryContents[index] == 0)
+		index++;
+	bZeros = index * 64ULL + CountTrailingZeros(b.binaryContents[index]);
+	unsignedBigInteger x = a >> aZeros, y = b >> bZeros, result;
+	if (x < y)
+		std::swap(x, y);
+
+	if (y.Size() == 1) {
+		// A single division is enough to continue with 64-bit integers
+		unsigned long long remainder = DivideLimbsBySingle(x.binaryContents.data(), x.binaryContents.data(), x.Size(), y.binaryContents[0]);
+		result = BinaryGcdOfLimbs(y.binaryContents[0], remainder);
+	}
+	else {
+		// Lehmer's algorithm (and the half-GCD for huge numbers)
+		std::vector<unsigned long long> limbs = GcdLimbs(std::vector<unsigned long long>(x.binaryContents.begin(), x.binaryContents.end()),
+			std::vector<unsigned long long>(y.binaryContents.begin(), y.binaryContents.end()));
+		result.isConvertedToDecimal = false;
+		result.Resize(limbs.size(), true);
+		result.binaryContents.assign(limbs.data(), limbs.size());
+		result.ShrinkContents();
+	}
+
+	// The maximum size is extended for the common factors of 2 (the zero elements are removed again)
+	unsigned long long commonZeros = std::min(aZeros, bZeros);
+	result.Resize(result.Size() + commonZeros / 64 + 1, true);
+	result.ShrinkContents();
+	return result <<= commonZeros;
+}
+
+unsignedBigInteger ExtendedGCD(const unsignedBigInteger& a, const unsignedBigInteger& b, unsignedBigInteger& x, unsignedBigInteger& y)
+{
+	if (b == 0) {
+		unsignedBigInteger result(a);
+		x = 1;
+		y = 0;
+		return result;
+	}
+	if (a == 0) {
+		// b * y = -b is not possible
+		unsignedBigInteger result(b);
+		x = 0;
+		y = 0;
+		return result;
+	}
+
+	std::vector<unsigned long long> cofactor;
+	bool isNegative;
+	std::vector<unsigned long long> limbs = ExtendedGcdLimbs(std::vector<unsigned long long>(a.binaryContents.begin(), a.binaryContents.end()),
+		std::vector<unsigned long long>(b.binaryContents.begin(), b.binaryContents.end()), cofactor, isNegative);
+	unsignedBigInteger result, coefficient;
+	result.isConvertedToDecimal = false;
+	result.Resize(limbs.size(), true);
+	result.binaryContents.assign(limbs.data(), limbs.size());
+	result.ShrinkContents();
+	coefficient.isConvertedToDecimal = false;
+	coefficient.Resize(cofactor.size(), true);
+	coefficient.binaryContents.assign(cofactor.data(), cofactor.size());
+	coefficient.ShrinkContents();
+
+	// x is the coefficient in the range [1, b / GCD], then y = (a * x - GCD) / b is an exact division
+	unsignedBigInteger period = b / result;
+	coefficient %= period;
+	if (isNegative && coefficient != 0)
+		coefficient = period - coefficient;
+	if (coefficient == 0)
+		coefficient = std::move(period);
+	unsignedBigInteger otherCoefficient = (a * coefficient - result) / b;
+	x = std::move(coefficient);
+	y = std::move(otherCoefficient);
+	return result;
+}
+
+// The product of values[first .. last) by a balanced tree
+static unsignedBigInteger ProductOfRange(const std::vector<unsignedBigInteger>& values, size_t first, size_t last)
+{
+	if (last - first == 1)
+		return values[first];
+	size_t middle = first + (last - first) / 2;
+	return ProductOfRange(values, first, middle) * ProductOfRange(values, middle, last);
+}
+
+unsignedBigInteger Product(const std::vector<unsignedBigInteger>& values)
+{
+	if (values.empty())
+		return unsignedBigInteger(1);
+	return ProductOfRange(values, 0, values.size());
+}
+
+unsignedBigInteger Factorial(unsigned long long n)
+{
+	// n! < n^n, which is checked before sieving the primes up to n
+	if (n > 1 && n > ABSOLUTE_MAX_SIZE * 64ULL / (64 - CountLeadingZeros(n))) {
+		printf("DEBUG: An error occurred while calculating the factorial: The result exceeds the absolute maximum size!\n");
+		return unsignedBigInteger(0);
+	}
+	std::vector<unsigned long long> limbs = OddFactorialLimbs(n, PrimesUpTo(n));
+
+	// The factors of 2: floor(n/2) + floor(n/4) + ... = n - (the number of 1 bits of n)
+	unsigned long long bits = 0;
+	for (unsigned long long value = n; value != 0; value &= value - 1)
+		bits++;
+
+	// The maximum size is extended for the shifted result (the zero elements are removed before shifting)
+	unsignedBigInteger result;
+	result.isConvertedToDecimal = false;
+	if (!result.Resize(limbs.size() + (n - bits) / 64 + 1, true))
+		return unsignedBigInteger(0);
+	std::copy(limbs.begin(), limbs.end(), result.binaryContents.begin());
+	result.ShrinkContents();
+	return result <<= n - bits;
 }
 
-unsignedBigInteger& unsignedBigInteger::FastPower(unsigned long long exponent)
+unsignedBigInteger Primorial(unsigned long long n)
 {
-	if (exponent == 0) {
-		*this = 1;
-		return *this;
+	// The product of the primes up to n is less than 2^(1.5 * n)
+	if (n / 2 * 3 > ABSOLUTE_MAX_SIZE * 64ULL) {
+		printf("DEBUG: An error occurred while calculating the primorial: The result exceeds the absolute maximum size!\n");
+		return unsignedBigInteger(0);
 	}
-	
-	if ((*this) == 0)
-		return (*this);
-
-	// [TODO: Check the expected size first]
-
-	unsignedBigInteger base(*this);
-	exponent--; // (*this) already contains the first power
+	std::vector<unsigned long long> limbs = ProductOfFactors(PrimesUpTo(n));
+	unsignedBigInteger result;
+	result.isConvertedToDecimal = false;
+	if (!result.Resize(limbs.size(), true))
+		return unsignedBigInteger(0);
+	std::copy(limbs.begin(), limbs.end(), result.binaryContents.begin());
+	result.ShrinkContents();
+	return result;
+}
 
-	while (exponent > 0) {
-		if ((exponent & 1) == 1)
-			(*this) *= base;
-		base *= base;
-		exponent >>= 1;
+unsignedBigInteger Binomial(unsigned long long n, unsigned long long k)
+{
+	if (k > n)
+		return unsignedBigInteger(0);
+	k = std::min(k, n - k);
+	std::vector<unsigned long long> limbs;
+	if (k < n / 16) {
+		// n * (n - 1) * ... * (n - k + 1) / k!, where the product has about k * log2(n) bits
+		if (k > ABSOLUTE_MAX_SIZE * 64ULL / (64 - CountLeadingZeros(n))) {
+			printf("DEBUG: An error occurred while calculating the binomial coefficient: The result exceeds the absolute maximum size!\n");
+			return unsignedBigInteger(0);
+		}
+		std::vector<unsigned long long> factors(k);
+		for (unsigned long long i = 0; i < k; i++)
+			factors[i] = n - i;
+		unsignedBigInteger factorial = Factorial(k);
+		std::vector<unsigned long long> remainder, denominator(factorial.binaryContents.begin(), factorial.binaryContents.end());
+		DivideLimbVectors(ProductOfFactors(factors), denominator, limbs, remainder);
 	}
-	return (*this);
+	else {
+		// C(n, k) < 2^n, and the exponent of each prime p is the number of borrows when subtracting k from n in base p (Kummer's theorem),
+		// so each factor p^e is at most n
+		if (n > ABSOLUTE_MAX_SIZE * 64ULL) {
+			printf("DEBUG: An error occurred while calculating the binomial coefficient: The result exceeds the absolute maximum size!\n");
+			return unsignedBigInteger(0);
+		}
+		std::vector<unsigned long long> primes = PrimesUpTo(n), factors;
+		for (unsigned long long p : primes) {
+			unsigned long long factor = 1, a = n, b = k, borrow = 0;
+			while (a > 0) {
+				borrow = (a % p) < (b % p) + borrow ? 1 : 0;
+				if (borrow)
+					factor *= p;
+				a /= p;
+				b /= p;
+			}
+			if (factor > 1)
+				factors.push_back(factor);
+		}
+		limbs = ProductOfFactors(factors);
+	}
+	unsignedBigInteger result;
+	result.isConvertedToDecimal = false;
+	if (!result.Resize(limbs.size(), true))
+		return unsignedBigInteger(0);
+	std::copy(limbs.begin(), limbs.end(), result.binaryContents.begin());
+	result.ShrinkContents();
+	return result;
 }
 
-inline unsignedBigInteger& unsignedBigInteger::FastPower(unsignedBigInteger &exponent)
+inline unsignedBigInteger& unsignedBigInteger::FastPower(const unsignedBigInteger& exponent)
 {
 	// Not allowing exponents that do not fit in 64-bit integer
 	return this->FastPower(exponent.ToULongLong());
@@ -646,73 +3591,73 @@ inline unsignedBigInteger& unsignedBigInteger::FastPower(unsignedBigInteger &exp
 // Comparison Operators (<, <=, >, >=, ==, !=) and Comaprison Functions:
 //=========================================================================================================================
 
-bool unsignedBigInteger::operator< (unsignedBigInteger& other)
+bool unsignedBigInteger::operator< (const unsignedBigInteger& other) const
 {
 	signed int result = CompareWith(other);
 	return (result <  0);
 }
 
-bool unsignedBigInteger::operator<=(unsignedBigInteger& other)
+bool unsignedBigInteger::operator<=(const unsignedBigInteger& other) const
 {
 	signed int result = CompareWith(other);
 	return (result <= 0);
 }
 
-bool unsignedBigInteger::operator> (unsignedBigInteger& other)
+bool unsignedBigInteger::operator> (const unsignedBigInteger& other) const
 {
 	signed int result = CompareWith(other);
 	return (result >  0);
 }
 
-bool unsignedBigInteger::operator>=(unsignedBigInteger& other)
+bool unsignedBigInteger::operator>=(const unsignedBigInteger& other) const
 {
 	signed int result = CompareWith(other);
 	return (result >= 0);
 }
 
-bool unsignedBigInteger::operator==(unsignedBigInteger& other)
+bool unsignedBigInteger::operator==(const unsignedBigInteger& other) const
 {
 	signed int result = CompareWith(other);
 	return (result == 0);
 }
 
-bool unsignedBigInteger::operator!=(unsignedBigInteger& other)
+bool unsignedBigInteger::operator!=(const unsignedBigInteger& other) const
 {
 	signed int result = CompareWith(other);
 	return (result != 0);
 }
 
-bool unsignedBigInteger::operator< (unsigned long long other)
+bool unsignedBigInteger::operator< (unsigned long long other) const
 {
 	signed int result = CompareWith(other);
 	return (result <  0);
 }
 
-bool unsignedBigInteger::operator<=(unsigned long long other)
+bool unsignedBigInteger::operator<=(unsigned long long other) const
 {
 	signed int result = CompareWith(other);
 	return (result <= 0);
 }
 
-bool unsignedBigInteger::operator> (unsigned long long other)
+bool unsignedBigInteger::operator> (unsigned long long other) const
 {
 	signed int result = CompareWith(other);
 	return (result >  0);
 }
 
-bool unsignedBigInteger::operator>=(unsigned long long other)
+bool unsignedBigInteger::operator>=(unsigned long long other) const
 {
 	signed int result = CompareWith(other);
 	return (result >= 0);
 }
 
-bool unsignedBigInteger::operator==(unsigned long long other)
+bool unsignedBigInteger::operator==(unsigned long long other) const
 {
 	signed int result = CompareWith(other);
 	return (result == 0);
 }
 
-bool unsignedBigInteger::operator!=(unsigned long long other)
+bool unsignedBigInteger::operator!=(unsigned long long other) const
 {
 	signed int result = CompareWith(other);
 	return (result != 0);
@@ -720,47 +3665,27 @@ bool unsignedBigInteger::operator!=(unsigned long long other)
 
 // This is the function that actually compares two big integers. All the comparison operator call this.
 // 0 = equals, +1 = greater, -1 = smaller
-signed int unsignedBigInteger::CompareWith(unsignedBigInteger& other)
+signed int unsignedBigInteger::CompareWith(const unsignedBigInteger& other) const
 {
-	ShrinkContents();
-	other.ShrinkContents();
-	if (Size() > other.Size())
-		return 1;
-	if (Size() < other.Size())
-		return -1;
-	for (unsigned int i = Size() - 1; ; i--) {
-		if (binaryContents[i] > other[i])
-			return 1;
-		if (binaryContents[i] < other[i])
-			return -1;
-		if (i == 0)
-			break;
-	}
-	return 0;
+	// Any leading zero elements are skipped, so neither number has to be shrunk
+	return CompareLimbs(binaryContents.data(), Size(), other.binaryContents.data(), other.Size());
 }
 
-signed int unsignedBigInteger::CompareWith(unsigned long long other)
+signed int unsignedBigInteger::CompareWith(unsigned long long other) const
 {
-	ShrinkContents();
-	if (Size() > 1)
-		return 1;
-	if (binaryContents[0] > other)
-		return 1;
-	if (binaryContents[0] < other)
-		return -1;
-	return 0;
+	return CompareLimbs(binaryContents.data(), Size(), &other, 1);
 }
 
 //=========================================================================================================================
 // Bitwise Operators (|, &, ^, |=, &=, ^=, ~) :
 //=========================================================================================================================
 
-unsignedBigInteger unsignedBigInteger::operator|(unsignedBigInteger& other)
+unsignedBigInteger unsignedBigInteger::operator|(const unsignedBigInteger& other) const&
 {
 	// These two pointers will point to (this) and (other) depending on how many elements are there in each of them (the size of binaryContents).
 	// The greaterNumber is not necessarily greater if they have the same number of elements, and it does not have to be.
-	unsignedBigInteger* greaterNumber;
-	unsignedBigInteger* smallerNumber;
+	const unsignedBigInteger* greaterNumber;
+	const unsignedBigInteger* smallerNumber;
 
 	if (Size() >= other.Size()) {
 		greaterNumber = this;
@@ -773,17 +3698,35 @@ unsignedBigInteger unsignedBigInteger::operator|(unsignedBigInteger& other)
 
 	// Construct a big integer from the greater number (in terms of size):
 	unsignedBigInteger result(*greaterNumber);
+	result.isConvertedToDecimal = false;
 	for (unsigned int i = 0; i < smallerNumber->Size(); i++)
 		result[i] |= (*smallerNumber)[i];
 	return result;
 }
 
-unsignedBigInteger unsignedBigInteger::operator&(unsignedBigInteger& other)
+unsignedBigInteger unsignedBigInteger::operator|(const unsignedBigInteger& other) &&
+{
+	// (*this) is a temporary, so the result is calculated in its contents
+	return std::move((*this) |= other);
+}
+
+unsignedBigInteger unsignedBigInteger::operator|(unsignedBigInteger&& other) const&
+{
+	// (other) is a temporary, so the result is calculated in its contents (the operation is commutative)
+	return std::move(other |= (*this));
+}
+
+unsignedBigInteger unsignedBigInteger::operator|(unsignedBigInteger&& other) &&
+{
+	return std::move((*this) |= other);
+}
+
+unsignedBigInteger unsignedBigInteger::operator&(const unsignedBigInteger& other) const&
 {
 	// These two pointers will point to (this) and (other) depending on how many elements are there in each of them (the size of binaryContents).
 	// The greaterNumber is not necessarily greater if they have the same number of elements, and it does not have to be.
-	unsignedBigInteger* greaterNumber;
-	unsignedBigInteger* smallerNumber;
+	const unsignedBigInteger* greaterNumber;
+	const unsignedBigInteger* smallerNumber;
 
 	if (Size() >= other.Size()) {
 		greaterNumber = this;
@@ -796,17 +3739,36 @@ unsignedBigInteger unsignedBigInteger::operator&(unsignedBigInteger& other)
 
 	// Construct a big integer from the smaller number (in terms of size):
 	unsignedBigInteger result(*smallerNumber);
+	result.isConvertedToDecimal = false;
 	for (unsigned int i = 0; i < smallerNumber->Size(); i++)
 		result[i] &= (*greaterNumber)[i];
+	result.ShrinkContents(); // The higher elements may become zeros
 	return result;
 }
 
-unsignedBigInteger unsignedBigInteger::operator^(unsignedBigInteger& other)
+unsignedBigInteger unsignedBigInteger::operator&(const unsignedBigInteger& other) &&
+{
+	// (*this) is a temporary, so the result is calculated in its contents
+	return std::move((*this) &= other);
+}
+
+unsignedBigInteger unsignedBigInteger::operator&(unsignedBigInteger&& other) const&
+{
+	// (other) is a temporary, so the result is calculated in its contents (the operation is commutative)
+	return std::move(other &= (*this));
+}
+
+unsignedBigInteger unsignedBigInteger::operator&(unsignedBigInteger&& other) &&
+{
+	return std::move((*this) &= other);
+}
+
+unsignedBigInteger unsignedBigInteger::operator^(const unsignedBigInteger& other) const&
 {
 	// These two pointers will point to (this) and (other) depending on how many elements are there in each of them (the size of binaryContents).
 	// The greaterNumber is not necessarily greater if they have the same number of elements, and it does not have to be.
-	unsignedBigInteger* greaterNumber;
-	unsignedBigInteger* smallerNumber;
+	const unsignedBigInteger* greaterNumber;
+	const unsignedBigInteger* smallerNumber;
 
 	if (Size() >= other.Size()) {
 		greaterNumber = this;
@@ -819,70 +3781,111 @@ unsignedBigInteger unsignedBigInteger::operator^(unsignedBigInteger& other)
 
 	// Construct a big integer from the greater number (in terms of size):
 	unsignedBigInteger result(*greaterNumber);
+	result.isConvertedToDecimal = false;
 	for (unsigned int i = 0; i < smallerNumber->Size(); i++)
 		result[i] ^= (*smallerNumber)[i];
+	result.ShrinkContents(); // The higher elements may become zeros
 	return result;
 }
 
-unsignedBigInteger unsignedBigInteger::operator|(unsigned long long other)
+unsignedBigInteger unsignedBigInteger::operator^(const unsignedBigInteger& other) &&
+{
+	// (*this) is a temporary, so the result is calculated in its contents
+	return std::move((*this) ^= other);
+}
+
+unsignedBigInteger unsignedBigInteger::operator^(unsignedBigInteger&& other) const&
+{
+	// (other) is a temporary, so the result is calculated in its contents (the operation is commutative)
+	return std::move(other ^= (*this));
+}
+
+unsignedBigInteger unsignedBigInteger::operator^(unsignedBigInteger&& other) &&
+{
+	return std::move((*this) ^= other);
+}
+
+unsignedBigInteger unsignedBigInteger::operator|(unsigned long long other) const&
 {
 	unsignedBigInteger result(*this);
+	result.isConvertedToDecimal = false;
 	result[0] |= other;
 	return result;
 }
 
-unsignedBigInteger unsignedBigInteger::operator&(unsigned long long other)
+unsignedBigInteger unsignedBigInteger::operator|(unsigned long long other) &&
+{
+	// (*this) is a temporary, so the result is calculated in its contents
+	return std::move((*this) |= other);
+}
+
+unsignedBigInteger unsignedBigInteger::operator&(unsigned long long other) const
 {
 	unsignedBigInteger result(other);
+	result.isConvertedToDecimal = false;
 	result[0] &= binaryContents[0];
 	return result;
 }
 
-unsignedBigInteger unsignedBigInteger::operator^(unsigned long long other)
+unsignedBigInteger unsignedBigInteger::operator^(unsigned long long other) const&
 {
 	unsignedBigInteger result(*this);
+	result.isConvertedToDecimal = false;
 	result[0] ^= other;
 	return result;
 }
 
-unsignedBigInteger& unsignedBigInteger::operator|=(unsignedBigInteger& other)
+unsignedBigInteger unsignedBigInteger::operator^(unsigned long long other) &&
+{
+	// (*this) is a temporary, so the result is calculated in its contents
+	return std::move((*this) ^= other);
+}
+
+unsignedBigInteger& unsignedBigInteger::operator|=(const unsignedBigInteger& other)
 {
+	isConvertedToDecimal = false; // decimalContents will not represent the new value
 	// Extend for extra elements
 	if (other.Size() > Size())
-		Resize(other.Size());
+		Resize(other.Size(), true);
 	for (unsigned int i = 0; i < other.Size(); i++)
 		binaryContents[i] |= other[i];
 	return *this;
 }
 
-unsignedBigInteger& unsignedBigInteger::operator&=(unsignedBigInteger& other)
+unsignedBigInteger& unsignedBigInteger::operator&=(const unsignedBigInteger& other)
 {
+	isConvertedToDecimal = false; // decimalContents will not represent the new value
 	// Remove any extra elements (same as AND with zeros)
 	if (other.Size() < Size())
 		Resize(other.Size());
 	for (unsigned int i = 0; i < Size(); i++)
 		binaryContents[i] &= other[i];
+	ShrinkContents(); // The higher elements may become zeros
 	return *this;
 }
 
-unsignedBigInteger& unsignedBigInteger::operator^=(unsignedBigInteger& other)
+unsignedBigInteger& unsignedBigInteger::operator^=(const unsignedBigInteger& other)
 {
+	isConvertedToDecimal = false; // decimalContents will not represent the new value
 	// Extend for extra elements
 	if (other.Size() > Size())
-		Resize(other.Size());
+		Resize(other.Size(), true);
 	for (unsigned int i = 0; i < other.Size(); i++)
 		binaryContents[i] ^= other[i];
+	ShrinkContents(); // The higher elements may become zeros
 	return *this;
 }
 
 unsignedBigInteger& unsignedBigInteger::operator|=(unsigned long long other)
 {
+	isConvertedToDecimal = false; // decimalContents will not represent the new value
 	binaryContents[0] |= other;
 	return *this;
 }
 
 unsignedBigInteger& unsignedBigInteger::operator&=(unsigned long long other)
 {
+	isConvertedToDecimal = false; // decimalContents will not represent the new value
 	Resize(1); // Remove any extra bytes (same as AND with zeros)
 	binaryContents[0] &= other;
 	return *this;
@@ -890,15 +3893,18 @@ unsignedBigInteger& unsignedBigInteger::operator&=(unsigned long long other)
 
 unsignedBigInteger& unsignedBigInteger::operator^=(unsigned long long other)
 {
+	isConvertedToDecimal = false; // decimalContents will not represent the new value
 	binaryContents[0] ^= other;
 	return *this;
 }
 
 unsignedBigInteger& unsignedBigInteger::operator~()
 {
-	// Inverting is the same as bitwise xor with all ones (without changing the size)
+	isConvertedToDecimal = false; // decimalContents will not represent the new value
+	// Inverting is the same as bitwise xor with all ones (within the current size)
 	for (unsigned int i = 0; i < Size(); i++)
 		binaryContents[i] ^= (LOW_DWORD | HIGH_DWORD);
+	ShrinkContents(); // The higher elements may become zeros
 	return *this;
 }
 
@@ -906,10 +3912,11 @@ unsignedBigInteger& unsignedBigInteger::operator~()
 // Shift Operators (<<, >>, <<=, >>=) and Shifting Functions:
 //=========================================================================================================================
 
-unsignedBigInteger unsignedBigInteger::operator<<(unsigned long long other)
+unsignedBigInteger unsignedBigInteger::operator<<(unsigned long long other) const&
 {
 	unsigned int shiftElements = other >> 6; // equivalent to division by 64
 	unsignedBigInteger result(*this);
+	result.isConvertedToDecimal = false;
 	if (shiftElements + Size() > MAX_SIZE)
 		return result;
 
@@ -933,18 +3940,27 @@ unsignedBigInteger unsignedBigInteger::operator<<(unsigned long long other)
 			previousHigherPart = higherPart;				// saving the higher part as the next element's previous one
 		}
 		// Add any extra higher part to a new element:
-		if (previousHigherPart != 0)
-			result.binaryContents.push_back(previousHigherPart);
+		if (previousHigherPart != 0) {
+			result.Resize(result.Size() + 1, true);
+			result.binaryContents.back() = previousHigherPart;
+		}
 	}
 	if (shiftElements != 0)
 		result.ShiftLeftBy(shiftElements);
 	return result;
 }
 
-unsignedBigInteger unsignedBigInteger::operator>>(unsigned long long other)
+unsignedBigInteger unsignedBigInteger::operator<<(unsigned long long other) &&
+{
+	// (*this) is a temporary, so the result is calculated in its contents
+	return std::move((*this) <<= other);
+}
+
+unsignedBigInteger unsignedBigInteger::operator>>(unsigned long long other) const&
 {
 	unsigned int shiftElements = other >> 6; // equivalent to division by 64
 	unsignedBigInteger result(*this);
+	result.isConvertedToDecimal = false;
 	if (shiftElements >= Size())
 		return unsignedBigInteger(0);
 
@@ -970,20 +3986,39 @@ unsignedBigInteger unsignedBigInteger::operator>>(unsigned long long other)
 	return result;
 }
 
-unsignedBigInteger unsignedBigInteger::operator<<(unsignedBigInteger& other)
+unsignedBigInteger unsignedBigInteger::operator>>(unsigned long long other) &&
+{
+	// (*this) is a temporary, so the result is calculated in its contents
+	return std::move((*this) >>= other);
+}
+
+unsignedBigInteger unsignedBigInteger::operator<<(const unsignedBigInteger& other) const&
 {
 	// Not allowing shifting by amounts that do not fit in 64-bit integer
 	return (*this) << other.ToULongLong();
 }
 
-unsignedBigInteger unsignedBigInteger::operator>>(unsignedBigInteger& other)
+unsignedBigInteger unsignedBigInteger::operator<<(const unsignedBigInteger& other) &&
+{
+	// (*this) is a temporary, so the result is calculated in its contents
+	return std::move((*this) <<= other);
+}
+
+unsignedBigInteger unsignedBigInteger::operator>>(const unsignedBigInteger& other) const&
 {
 	// Not allowing shifting by amounts that do not fit in 64-bit integer
 	return (*this) >> other.ToULongLong();
 }
 
+unsignedBigInteger unsignedBigInteger::operator>>(const unsignedBigInteger& other) &&
+{
+	// (*this) is a temporary, so the result is calculated in its contents
+	return std::move((*this) >>= other);
+}
+
 unsignedBigInteger& unsignedBigInteger::operator<<=(unsigned long long other)
 {
+	isConvertedToDecimal = false; // decimalContents will not represent the new value
 	unsigned int shiftElements = other >> 6; // equivalent to division by 64
 	if (shiftElements + Size() > MAX_SIZE)
 		return (*this);
@@ -1001,8 +4036,10 @@ unsignedBigInteger& unsignedBigInteger::operator<<=(unsigned long long other)
 			previousHigherPart = higherPart;						// saving the higher part as the next element's previous one
 		}
 		// Any extra higher part will be added to a new element:
-		if (previousHigherPart != 0)
-			binaryContents.push_back(previousHigherPart);
+		if (previousHigherPart != 0) {
+			Resize(Size() + 1, true);
+			binaryContents.back() = previousHigherPart;
+		}
 	}
 	if (shiftElements != 0)
 		ShiftLeftBy(shiftElements);
@@ -1011,6 +4048,7 @@ unsignedBigInteger& unsignedBigInteger::operator<<=(unsigned long long other)
 
 unsignedBigInteger& unsignedBigInteger::operator>>=(unsigned long long other)
 {
+	isConvertedToDecimal = false; // decimalContents will not represent the new value
 	unsigned int shiftElements = other >> 6; // equivalent to division by 64
 	if (shiftElements >= Size())
 		return (*this) = 0;
@@ -1037,13 +4075,13 @@ unsignedBigInteger& unsignedBigInteger::operator>>=(unsigned long long other)
 	return *this;
 }
 
-unsignedBigInteger& unsignedBigInteger::operator<<=(unsignedBigInteger& other)
+unsignedBigInteger& unsignedBigInteger::operator<<=(const unsignedBigInteger& other)
 {
 	// Not allowing shifting by amounts that do not fit in 64-bit integer
 	return (*this) <<= other.ToULongLong();
 }
 
-unsignedBigInteger& unsignedBigInteger::operator>>=(unsignedBigInteger& other)
+unsignedBigInteger& unsignedBigInteger::operator>>=(const unsignedBigInteger& other)
 {
 	// Not allowing shifting by amounts that do not fit in 64-bit integer
 	return (*this) >>= other.ToULongLong();
@@ -1052,6 +4090,7 @@ unsignedBigInteger& unsignedBigInteger::operator>>=(unsignedBigInteger& other)
 // These 2 functions shift by elements of 64-bit integers
 unsignedBigInteger& unsignedBigInteger::ShiftRightBy(unsigned int shift)
 {
+	isConvertedToDecimal = false; // decimalContents will not represent the new value
 	// Preventing shifting by more than the size
 	if (Size() <= shift)
 		(*this) = 0;
@@ -1068,11 +4107,15 @@ unsignedBigInteger& unsignedBigInteger::ShiftRightBy(unsigned int shift)
 
 unsignedBigInteger& unsignedBigInteger::ShiftLeftBy(unsigned int shift)
 {
+	isConvertedToDecimal = false; // decimalContents will not represent the new value
 	// Cannot shift to the left if the value is already 0 
 	if ((*this) == 0)
 		return (*this);
 
-	Resize(Size() + shift);
+	if (!Resize(Size() + shift, true)) {
+		printf("DEBUG: An error occurred while shifting: The result exceeds the absolute maximum size!\n");
+		return (*this) = 0;
+	}
 	for (unsigned int i = Size() - 1; i >= shift; i--)
 		binaryContents[i] = binaryContents[i - shift];
 	for (unsigned int i = 0; i < shift; i++)
@@ -1132,8 +4175,13 @@ bool unsignedBigInteger::PrintAsBinary(char charAfter)
 
 unsigned int unsignedBigInteger::NumberOfDigits()
 {
-	std::string str = ConvertToString(10);
-	return str.length();
+	// All the packets of decimalContents have 9 digits except the most significant one
+	if (!ConvertToDecimal())
+		return 0;
+	unsigned int result = 9 * (decimalContents.size() - 1) + 1;
+	for (unsigned int packet = decimalContents.back(); packet >= 10; packet /= 10)
+		result++;
+	return result;
 }
 
 unsigned int unsignedBigInteger::NumberOfBits()
@@ -1148,12 +4196,12 @@ unsigned int unsignedBigInteger::NumberOfBits()
 	return result;
 }
 
-inline unsigned long long unsignedBigInteger::Size()
+inline unsigned long long unsignedBigInteger::Size() const
 {
 	return binaryContents.size();
 }
 
-inline unsigned unsigned long long unsignedBigInteger::GetMaximumSize()
+inline unsigned long long unsignedBigInteger::GetMaximumSize() const
 {
 	return MAX_SIZE;
 }
@@ -1164,11 +4212,11 @@ bool unsignedBigInteger::Resize(unsigned int newSize, bool extendMaxSize)
 	if (newSize > ABSOLUTE_MAX_SIZE)
 		return false;
 
-	// Preventing exceeding the maximum size if it is not extendable
+	// Preventing exceeding the maximum size if it is not extendable (shrinking is always allowed)
 	if (extendMaxSize)
 		while (MAX_SIZE < newSize)
 			MAX_SIZE <<= 1;
-	else if (newSize > MAX_SIZE)
+	else if (newSize > MAX_SIZE && newSize > Size())
 		return false;
 
 	// Preventing deletion of the vector binaryContents:
@@ -1192,21 +4240,6 @@ bool unsignedBigInteger::ShrinkContents()
 	return result;
 }
 
-std::vector<unsigned long long> unsignedBigInteger::GetExpandedContents()
-{
-	std::vector<unsigned long long> result(Size() << 1);
-	for (unsigned long long i = 0; i < Size(); i++) {
-		unsigned long long currentElement = binaryContents[i];
-		result[i << 1] = currentElement & LOW_DWORD;
-		result[(i << 1) + 1] = (currentElement & HIGH_DWORD) >> 32;
-	}
-
-	// removing all leading zeros
-	while (result.size() > 1 && result.back() == 0)
-		result.pop_back();
-	return result;
-}
-
 // This function will return the number of trailing zeros and will remove them, so be careful when calling it!!
 // It will be helpful for muliplication and division.
 // [TODO: Un-implemented function]
@@ -1219,12 +4252,12 @@ unsigned int unsignedBigInteger::RemoveTrailingZeros()
 // Converting Functions:
 //=========================================================================================================================
 
-inline unsigned int unsignedBigInteger::ToUInt()
+inline unsigned int unsignedBigInteger::ToUInt() const
 {
 	return binaryContents[0] & LOW_DWORD; // lowest 4 bytes
 }
 
-inline unsigned long long unsignedBigInteger::ToULongLong()
+inline unsigned long long unsignedBigInteger::ToULongLong() const
 {
 	return binaryContents[0]; // lowest 8 bytes
 }
@@ -1234,17 +4267,16 @@ std::string unsignedBigInteger::ConvertToString(unsigned int base)
 	if (base == 10) {
 		if (!ConvertToDecimal())
 			return "0";
-		std::string result = "";
-		result.reserve(9 * decimalContents.size());
+		// The digits are written directly into their places (9 per packet, starting from the least significant)
+		std::string result(9 * decimalContents.size(), '0');
 		for (unsigned int i = 0; i < decimalContents.size(); i++) {
-			// Zero padding for each packet:
-			char packet[10];
-			sprintf_s(packet, "%09d", decimalContents[i]); // Apparently, sprintf is not safe according to MS-VS
-			result = packet + result;
+			unsigned int packet = decimalContents[i];
+			for (unsigned int position = result.size() - 9 * i; packet > 0; packet /= 10)
+				result[--position] = '0' + packet % 10;
 		}
-		// Remove any possible leading zeros
+		// Remove any possible leading zeros (from the most significant packet)
 		unsigned int lastZero = 0;
-		while (result[lastZero] == '0')
+		while (lastZero < result.size() - 1 && result[lastZero] == '0')
 			lastZero++;
 		return result.substr(lastZero);
 	}
@@ -1258,38 +4290,32 @@ std::string unsignedBigInteger::ConvertToString(unsigned int base)
 
 bool unsignedBigInteger::ConvertToDecimal()
 {
-	// [TODO: Un-implemented functionality]
-	// if (isConvertedToDecimal)
-	//	return true;
+	// decimalContents is kept until the value is changed by any operation, so the conversion is done only once for each value
+	if (isConvertedToDecimal)
+		return true;
 
 	// conversion operation
-	unsigned int packetSize = E9; // 10^9
-	decimalContents.clear();
-	
-	unsignedBigInteger dividend(*this), quotient;
-	unsigned int packetNumber;
-
-	while (dividend > 0) {
-		// Replaced by the below function (2 calculations at once)
-		// packetNumber = (dividend % packetSize).ToULongLong();
-		// dividend /= packetSize;
-
-		if (Divide(dividend, packetSize, quotient, packetNumber))
-			std::swap(dividend, quotient);
-		else {
-			printf("DEBUG: Error in conversion to decimal!\n");
-			decimalContents.clear();
-			break;
-		}
-		
-		decimalContents.push_back(packetNumber);
+	std::vector<unsigned long long> number(binaryContents.begin(), binaryContents.end());
+	TrimLimbs(number);
+
+	if (number.size() < DECIMAL_CONVERSION_THRESHOLD) {
+		// Dividing by 10^18 (the largest power of 10^9 that fits in 64-bit) gives two packets of 9 digits at each step,
+		// and each 64-bit element needs less than 3 packets
+		decimalContents.assign(3 * number.size(), 0);
+		LimbsToPacketsBasecase(number, decimalContents.data(), decimalContents.size());
+	}
+	else {
+		// Recursive splitting by the powers 10^(9 * 2^k) up to the first one greater than the number
+		unsigned int level = DecimalLevelOfBits(BitLengthOfLimbs(number));
+		std::vector<std::vector<unsigned long long>> powers = DecimalPowers(level);
+		decimalContents.assign(1U << level, 0);
+		LimbsToPackets(number, powers, level, decimalContents.data());
 	}
 	
-	if (decimalContents.empty())
-		decimalContents.push_back(0);
-	return true;
-	// [TODO: Un-implemented functionality] 
-	// update isConvertedToDecimal, and update it to false in all operations
+	// Remove the zero packets at the most significant part
+	while (decimalContents.size() > 1 && decimalContents.back() == 0)
+		decimalContents.pop_back();
+	return isConvertedToDecimal = true;
 }
 
 bool unsignedBigInteger::ConvertFromStringDecimal(std::string str)
@@ -1298,21 +4324,37 @@ bool unsignedBigInteger::ConvertFromStringDecimal(std::string str)
 		if (ch < '0' || ch>'9')
 			return isConvertedToDecimal = false;
 
+	// The string is divided into packets of 9 digits starting from its end (the least significant digits),
+	// which are exactly the elements of decimalContents
 	unsigned int stringSize = str.length();
-	const unsigned long long packetSize = E18; // 10^18
-	const unsigned int packetLength = 18; // 18 digits at a time
-	(*this) = 0;
-	decimalContents.clear();
-	decimalContents.reserve(1 + stringSize / packetLength);
-
-	for (unsigned int i = 0; i < stringSize; i += packetLength) {
-		std::string packetString = str.substr(i, packetLength);
-		unsigned long long packetNumber = std::stoull(packetString);
-		(*this) *= packetSize;
-		(*this) += packetNumber;
-		decimalContents.push_back(packetNumber);
+	const unsigned int packetLength = 9; // 9 digits at a time
+	decimalContents.assign(std::max((stringSize + packetLength - 1) / packetLength, 1U), 0);
+	for (unsigned int i = 0; i < stringSize; i++) {
+		unsigned int packetIndex = (stringSize - 1 - i) / packetLength;
+		decimalContents[packetIndex] = decimalContents[packetIndex] * 10 + (str[i] - '0');
+	}
+	while (decimalContents.size() > 1 && decimalContents.back() == 0)
+		decimalContents.pop_back();
+
+	// Combining the packets into 64-bit elements, either 2 packets at a time (for small numbers)
+	// or recursively by the powers 10^(9 * 2^k) (see PacketsToLimbs)
+	unsigned int packetCount = decimalContents.size();
+	std::vector<unsigned long long> result;
+	if (packetCount < 2 * DECIMAL_CONVERSION_THRESHOLD)
+		result = PacketsToLimbsBasecase(decimalContents.data(), packetCount);
+	else {
+		unsigned int level = 0;
+		while ((2U << level) < packetCount)
+			level++;
+		result = PacketsToLimbs(decimalContents.data(), packetCount, DecimalPowers(level + 1));
 	}
 
+	if (!Resize(result.size(), true)) {
+		printf("DEBUG: The number is too large to be stored!\n");
+		(*this) = 0;
+		return isConvertedToDecimal = false;
+	}
+	binaryContents.assign(result.data(), result.size());
 	return isConvertedToDecimal = true;
 }
 
@@ -1347,3 +4389,449 @@ bool unsignedBigInteger::ConvertFromStringHex(std::string str)
 
 	return true;
 }
+
+//=========================================================================================================================
+// Modular Arithmetic:
+//=========================================================================================================================
+
+montgomeryContext::montgomeryContext(const unsignedBigInteger& modulus) : modulus(modulus)
+{
+	if (modulus <= 1 || (modulus.binaryContents[0] & 1) == 0) {
+		printf("DEBUG: An error occurred in the Montgomery context: The modulus must be odd and greater than 1!\n");
+		return;
+	}
+	size = modulus.Size();
+	inverse = NegativeInverseOfLimb(modulus.binaryContents[0]);
+	if (size >= MONTGOMERY_REDC_THRESHOLD)
+		inverseLimbs = MontgomeryInverseLimbs(modulus.binaryContents.data(), size);
+
+	// R^2 mod modulus (this is the only division), where R^2 = 2^(128 * size) is built directly as its limbs may exceed the maximum size
+	unsignedBigInteger power;
+	power.isConvertedToDecimal = false;
+	if (!power.Resize(2 * size + 1, true)) {
+		printf("DEBUG: An error occurred in the Montgomery context: The modulus exceeds the absolute maximum size!\n");
+		return;
+	}
+	power.binaryContents.back() = 1;
+	rSquared = ToLimbs(power);
+	isValid = true;
+}
+
+std::vector<unsigned long long> montgomeryContext::ToLimbs(const unsignedBigInteger& x) const
+{
+	std::vector<unsigned long long> result(size, 0);
+	if (x >= modulus) {
+		unsignedBigInteger reduced = x % modulus;
+		std::copy(reduced.binaryContents.begin(), reduced.binaryContents.end(), result.begin());
+	}
+	else
+		std::copy(x.binaryContents.begin(), x.binaryContents.end(), result.begin());
+	return result;
+}
+
+unsignedBigInteger montgomeryContext::FromLimbs(const std::vector<unsigned long long>& limbs) const
+{
+	unsignedBigInteger result;
+	result.isConvertedToDecimal = false;
+	result.Resize(limbs.size(), true);
+	result.binaryContents.assign(limbs.data(), limbs.size());
+	result.ShrinkContents();
+	return result;
+}
+
+unsignedBigInteger montgomeryContext::ToMontgomery(const unsignedBigInteger& x) const
+{
+	if (!isValid)
+		return unsignedBigInteger(0);
+	// (x * R^2) * R^-1 = x * R
+	std::vector<unsigned long long> limbs = ToLimbs(x), scratch(6 * size + 1);
+	MontgomeryMultiplyLimbs(limbs.data(), rSquared.data(), modulus.binaryContents.data(), size, inverse, inverseLimbs.data(),
+		limbs.data(), scratch.data());
+	return FromLimbs(limbs);
+}
+
+unsignedBigInteger montgomeryContext::FromMontgomery(const unsignedBigInteger& x) const
+{
+	if (!isValid)
+		return unsignedBigInteger(0);
+	// (x * R) * R^-1 = x
+	std::vector<unsigned long long> limbs = ToLimbs(x), t(2 * size + 1, 0), scratch(4 * size);
+	std::copy(limbs.begin(), limbs.end(), t.begin());
+	MontgomeryReduce(t.data(), modulus.binaryContents.data(), size, inverse, inverseLimbs.data(), limbs.data(), scratch.data());
+	return FromLimbs(limbs);
+}
+
+unsignedBigInteger montgomeryContext::Multiply(const unsignedBigInteger& a, const unsignedBigInteger& b) const
+{
+	if (!isValid)
+		return unsignedBigInteger(0);
+	std::vector<unsigned long long> aLimbs = ToLimbs(a), bLimbs = ToLimbs(b), scratch(6 * size + 1);
+	MontgomeryMultiplyLimbs(aLimbs.data(), bLimbs.data(), modulus.binaryContents.data(), size, inverse, inverseLimbs.data(),
+		aLimbs.data(), scratch.data());
+	return FromLimbs(aLimbs);
+}
+
+unsignedBigInteger montgomeryContext::Square(const unsignedBigInteger& a) const
+{
+	if (!isValid)
+		return unsignedBigInteger(0);
+	std::vector<unsigned long long> limbs = ToLimbs(a), scratch(6 * size + 1);
+	MontgomeryMultiplyLimbs(limbs.data(), limbs.data(), modulus.binaryContents.data(), size, inverse, inverseLimbs.data(),
+		limbs.data(), scratch.data());
+	return FromLimbs(limbs);
+}
+
+/*	Sliding window exponentiation: the bits of the exponent are scanned from the most significant,
+*	and each window of up to (windowSize) bits that starts and ends with 1 is done by a single multiplication by an odd power of the base
+*	(taken from a table of base^1, base^3, base^5, ...), after squaring once for each bit of the window.
+*	All the calculations are done in the Montgomery form on (size) elements, so no division is needed after the constructor.
+*/
+unsignedBigInteger montgomeryContext::Power(const unsignedBigInteger& base, const unsignedBigInteger& exponent) const
+{
+	if (!isValid)
+		return unsignedBigInteger(0);
+	if (exponent == 0)
+		return unsignedBigInteger(1);
+
+	const unsigned long long* m = modulus.binaryContents.data();
+	const unsigned long long* mInverse = inverseLimbs.data();
+	std::vector<unsigned long long> scratch(6 * size + 1);
+	auto bitAt = [&exponent](unsigned long long i) { return (exponent.binaryContents[i >> 6] >> (i & 63)) & 1; };
+
+	unsigned long long bits = (exponent.Size() - 1) * 64 + 64 - CountLeadingZeros(exponent.binaryContents.back());
+	unsigned int windowSize = bits > 671 ? 6 : bits > 239 ? 5 : bits > 79 ? 4 : bits > 23 ? 3 : bits > 6 ? 2 : 1;
+
+	// table[j] = base^(2j + 1) in the Montgomery form
+	std::vector<std::vector<unsigned long long>> table(1ULL << (windowSize - 1));
+	table[0] = ToLimbs(base);
+	MontgomeryMultiplyLimbs(table[0].data(), rSquared.data(), m, size, inverse, mInverse, table[0].data(), scratch.data());
+	if (table.size() > 1) {
+		std::vector<unsigned long long> baseSquared(size);
+		MontgomeryMultiplyLimbs(table[0].data(), table[0].data(), m, size, inverse, mInverse, baseSquared.data(), scratch.data());
+		for (unsigned int j = 1; j < table.size(); j++) {
+			table[j].resize(size);
+			MontgomeryMultiplyLimbs(table[j - 1].data(), baseSquared.data(), m, size, inverse, mInverse, table[j].data(), scratch.data());
+		}
+	}
+
+	std::vector<unsigned long long> result;
+	for (unsigned long long i = bits; i-- > 0; ) {
+		if (bitAt(i) == 0) {
+			MontgomeryMultiplyLimbs(result.data(), result.data(), m, size, inverse, mInverse, result.data(), scratch.data());
+			continue;
+		}
+
+		// The window is [low .. i], and it ends with a 1 bit
+		unsigned long long low = i + 1 >= windowSize ? i + 1 - windowSize : 0;
+		while (bitAt(low) == 0)
+			low++;
+		unsigned long long window = 0;
+		for (unsigned long long j = i + 1; j-- > low; )
+			window = (window << 1) | bitAt(j);
+
+		if (result.empty())
+			result = table[window >> 1]; // the first window (all the bits before it are zeros)
+		else {
+			for (unsigned long long j = low; j <= i; j++)
+				MontgomeryMultiplyLimbs(result.data(), result.data(), m, size, inverse, mInverse, result.data(), scratch.data());
+			MontgomeryMultiplyLimbs(result.data(), table[window >> 1].data(), m, size, inverse, mInverse, result.data(), scratch.data());
+		}
+		i = low;
+	}
+
+	// Back to the normal form
+	std::vector<unsigned long long> t(2 * size + 1, 0);
+	std::copy(result.begin(), result.end(), t.begin());
+	MontgomeryReduce(t.data(), m, size, inverse, mInverse, result.data(), scratch.data());
+	return FromLimbs(result);
+}
+
+barrettReducer::barrettReducer(const unsignedBigInteger& modulus) : modulus(modulus)
+{
+	if (modulus == 0) {
+		printf("DEBUG: An error occurred in the Barrett reducer: Division by 0!\n");
+		return;
+	}
+	size = modulus.Size();
+
+	// mu = 2^(128 * size) / modulus (this is the only division), where the power is built directly as its limbs may exceed the maximum size
+	unsignedBigInteger power;
+	power.isConvertedToDecimal = false;
+	if (!power.Resize(2 * size + 1, true)) {
+		printf("DEBUG: An error occurred in the Barrett reducer: The modulus exceeds the absolute maximum size!\n");
+		return;
+	}
+	power.binaryContents.back() = 1;
+	unsignedBigInteger quotient = power / modulus;
+	mu.assign(quotient.binaryContents.begin(), quotient.binaryContents.end());
+	isValid = true;
+}
+
+unsignedBigInteger barrettReducer::Reduce(const unsignedBigInteger& x) const
+{
+	if (!isValid)
+		return unsignedBigInteger(0);
+	if (x < modulus)
+		return x;
+
+	const unsigned long long* m = modulus.binaryContents.data();
+	unsignedBigInteger result;
+	result.isConvertedToDecimal = false;
+	result.Resize(size, true);
+	unsigned int xSize = x.Size();
+	std::vector<unsigned long long> scratch(5 * size + 6);
+	if (xSize <= 2 * size)
+		BarrettReduceLimbs(x.binaryContents.data(), xSize, m, size, mu.data(), mu.size(), result.binaryContents.data(), scratch.data());
+	else {
+		// Bigger inputs are reduced from the most significant limbs, (size) limbs at a time after the remainder of the higher ones
+		// The window holds the next limbs of x below the current remainder
+		std::vector<unsigned long long> window(2 * size);
+		unsigned int position = xSize - 2 * size;
+		BarrettReduceLimbs(x.binaryContents.data() + position, 2 * size, m, size, mu.data(), mu.size(), result.binaryContents.data(), scratch.data());
+		while (position > 0) {
+			unsigned int count = std::min(size, position);
+			position -= count;
+			std::copy(x.binaryContents.data() + position, x.binaryContents.data() + position + count, window.data());
+			std::copy(result.binaryContents.data(), result.binaryContents.data() + size, window.data() + count);
+			BarrettReduceLimbs(window.data(), size + count, m, size, mu.data(), mu.size(), result.binaryContents.data(), scratch.data());
+		}
+	}
+	result.ShrinkContents();
+	return result;
+}
+
+unsignedBigInteger ModPow(const unsignedBigInteger& base, const unsignedBigInteger& exponent, const unsignedBigInteger& modulus)
+{
+	if (modulus == 0) {
+		printf("DEBUG: An error occurred during modular exponentiation: Division by 0!\n");
+		return unsignedBigInteger(0);
+	}
+	if (modulus == 1)
+		return unsignedBigInteger(0);
+
+	if ((modulus.binaryContents[0] & 1) == 1)
+		return montgomeryContext(modulus).Power(base, exponent);
+
+	// The Montgomery form needs an odd modulus, so even moduli are reduced by a division after each step (right to left)
+	unsignedBigInteger result(1), power(base % modulus);
+	unsigned long long bits = (exponent.Size() - 1) * 64 + 64 - CountLeadingZeros(exponent.binaryContents.back());
+	for (unsigned long long i = 0; i < bits; i++) {
+		if ((exponent.binaryContents[i >> 6] >> (i & 63)) & 1) {
+			result *= power;
+			result %= modulus;
+		}
+		if (i + 1 < bits) {
+			power.Square();
+			power %= modulus;
+		}
+	}
+	return result;
+}
+
+unsignedBigInteger ModInverse(const unsignedBigInteger& a, const unsignedBigInteger& modulus)
+{
+	if (modulus == 0) {
+		printf("DEBUG: An error occurred during modular inversion: Division by 0!\n");
+		return unsignedBigInteger(0);
+	}
+	if (modulus == 1)
+		return unsignedBigInteger(0);
+	unsignedBigInteger reduced = a % modulus;
+	if (reduced == 0)
+		return unsignedBigInteger(0);
+
+	// Only the coefficient of a is needed: GCD = x * a (mod modulus)
+	std::vector<unsigned long long> cofactor;
+	bool isNegative;
+	std::vector<unsigned long long> gcd = ExtendedGcdLimbs(std::vector<unsigned long long>(reduced.binaryContents.begin(), reduced.binaryContents.end()),
+		std::vector<unsigned long long>(modulus.binaryContents.begin(), modulus.binaryContents.end()), cofactor, isNegative);
+	if (gcd.size() != 1 || gcd[0] != 1)
+		return unsignedBigInteger(0); // a is not invertible
+	unsignedBigInteger result;
+	result.isConvertedToDecimal = false;
+	result.Resize(cofactor.size(), true);
+	result.binaryContents.assign(cofactor.data(), cofactor.size());
+	result.ShrinkContents();
+	result %= modulus;
+	if (isNegative && result != 0)
+		result = modulus - result;
+	return result;
+}
+
+bool unsignedBigInteger::IsProbablePrime(unsigned int rounds) const
+{
+	if (Size() == 1 && binaryContents[0] < 4)
+		return binaryContents[0] >= 2;
+	if ((binaryContents[0] & 1) == 0)
+		return false;
+
+	// Trial division: the remainders by all the small primes are found in a single pass
+	const SmallPrimeTable& table = GetSmallPrimeTable();
+	std::vector<unsigned long long> remainders(table.trialProducts);
+	RemaindersBySmallPrimes(binaryContents.data(), Size(), table.products.data(), table.trialProducts, remainders.data());
+	for (unsigned int k = 0; k < table.trialProducts; k++)
+		for (unsigned int i = table.products[k].first; i < table.products[k].last; i++)
+			if (remainders[k] % table.primes[i] == 0)
+				return Size() == 1 && binaryContents[0] == table.primes[i];
+
+	// A number below TRIAL_DIVISION_LIMIT^2 without a smaller factor is a prime
+	if (Size() == 1 && binaryContents[0] < (unsigned long long)TRIAL_DIVISION_LIMIT * TRIAL_DIVISION_LIMIT)
+		return true;
+	return IsStrongProbablePrime(rounds);
+}
+
+bool unsignedBigInteger::IsStrongProbablePrime(unsigned int rounds) const
+{
+	// (*this) - 1 = d * 2^s, where d is odd
+	unsignedBigInteger d = (*this) - 1;
+	unsigned long long s = 0;
+	unsigned int index = 0;
+	while (d.binaryContents[index] == 0)
+		index++;
+	s = index * 64ULL + CountTrailingZeros(d.binaryContents[index]);
+	d >>= s;
+
+	// The powers are compared in the Montgomery form, so the squares do not need to be converted back
+	montgomeryContext context(*this);
+	unsignedBigInteger one = context.ToMontgomery(1), minusOne = context.ToMontgomery((*this) - 1);
+
+	// The first 12 primes as bases are enough for any 64-bit number, otherwise the bases are 2 and random numbers in [2, (*this) - 2]
+	static const unsigned long long fixedBases[] = { 2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37 };
+	thread_local std::mt19937_64 generator(std::random_device{}());
+	if (Size() == 1)
+		rounds = sizeof(fixedBases) / sizeof(fixedBases[0]);
+	else if (rounds == 0)
+		rounds = 1;
+	for (unsigned int round = 0; round < rounds; round++) {
+		unsignedBigInteger base;
+		if (Size() == 1 || round == 0)
+			base = fixedBases[round];
+		else {
+			base.isConvertedToDecimal = false;
+			base.Resize(Size(), true);
+			for (unsigned int i = 0; i < Size(); i++)
+				base.binaryContents[i] = generator();
+			base.ShrinkContents();
+			base %= (*this) - 3;
+			base += 2;
+		}
+
+		// base^d = 1, or base^(d * 2^i) = -1 for some i < s
+		unsignedBigInteger x = context.ToMontgomery(context.Power(base, d));
+		if (x == one || x == minusOne)
+			continue;
+		bool isWitness = true;
+		for (unsigned long long i = 1; i < s && isWitness; i++) {
+			x = context.Square(x);
+			if (x == minusOne)
+				isWitness = false;
+			else if (x == one)
+				break;
+		}
+		if (isWitness)
+			return false;
+	}
+	return true;
+}
+
+unsignedBigInteger unsignedBigInteger::NextPrime(unsigned int rounds) const
+{
+	if ((*this) < 2)
+		return unsignedBigInteger(2);
+	unsignedBigInteger start = (*this) + 1;
+	if ((start.binaryContents[0] & 1) == 0)
+		start += 1;
+
+	// Each window of odd numbers (start + 2 * i) is sieved by the small primes: the first multiple of p is at i = (p - r) / 2 (mod p),
+	// where r = start mod p, then only the remaining numbers are tested by Miller-Rabin
+	const SmallPrimeTable& table = GetSmallPrimeTable();
+	std::vector<unsigned long long> remainders(table.products.size());
+	std::vector<bool> isComposite(SIEVE_WINDOW);
+	for (;;) {
+		RemaindersBySmallPrimes(start.binaryContents.data(), start.Size(), table.products.data(), table.products.size(), remainders.data());
+		std::fill(isComposite.begin(), isComposite.end(), false);
+		bool isSmall = start.Size() == 1 && start.binaryContents[0] <= SIEVE_LIMIT;
+		for (unsigned int k = 0; k < table.products.size(); k++) {
+			for (unsigned int j = table.products[k].first; j < table.products[k].last; j++) {
+				unsigned long long p = table.primes[j], r = remainders[k] % p;
+				unsigned long long i = r == 0 ? 0 : ((p - r) % 2 == 0 ? (p - r) / 2 : (2 * p - r) / 2);
+				if (isSmall && start.binaryContents[0] + 2 * i == p)
+					i += p; // p itself is not composite
+				for (; i < SIEVE_WINDOW; i += p)
+					isComposite[i] = true;
+			}
+		}
+
+		for (unsigned int i = 0; i < SIEVE_WINDOW; i++) {
+			if (isComposite[i])
+				continue;
+			unsignedBigInteger candidate = start + 2ULL * i;
+			// A number below SIEVE_LIMIT^2 without a smaller factor is a prime
+			if (candidate.Size() == 1 && candidate.binaryContents[0] < (unsigned long long)SIEVE_LIMIT * SIEVE_LIMIT)
+				return candidate;
+			if (candidate.IsStrongProbablePrime(rounds))
+				return candidate;
+		}
+		start += 2ULL * SIEVE_WINDOW;
+	}
+}
+
+//=========================================================================================================================
+// Batch Operations:
+//=========================================================================================================================
+
+// results[i] = calculate(i) for i = 0 .. count-1, in ranges on the threads of the pool (or of the current thread's pool).
+// Each thread has its own limbPool (the scratch), which is set as the allocator of every calculation that runs on it,
+// so the memory of the temporary numbers is reused by the next calculations (and the next batches) on the same thread.
+// Each result is copied out of the scratch to memory of new[], so nothing is shared between the threads but the inputs.
+// The products inside each calculation are split across the same pool if they are big enough.
+static void RunBatch(unsigned int count, threadPool* pool, unsignedBigInteger* results,
+	const std::function<unsignedBigInteger(unsigned int)>& calculate)
+{
+	if (pool == nullptr)
+		pool = threadPool::GetCurrent();
+	ParallelRanges(pool != nullptr && pool->GetThreads() > 1 ? pool : nullptr, count, 1, [&](unsigned int begin, unsigned int end) {
+		static thread_local limbPool scratch;
+		threadPoolScope poolScope(pool);
+		for (unsigned int i = begin; i < end; i++) {
+			unsignedBigInteger value;
+			{
+				limbAllocatorScope scope(&scratch);
+				value = calculate(i);
+			}
+			limbAllocatorScope scope(nullptr);
+			results[i] = value; // the memory of (value) goes back to the scratch
+		}
+	});
+}
+
+void BatchMultiply(const unsignedBigInteger* a, const unsignedBigInteger* b, unsignedBigInteger* results, unsigned int count,
+	threadPool* pool)
+{
+	RunBatch(count, pool, results, [&](unsigned int i) { return a[i] * b[i]; });
+}
+
+void BatchMod(const unsignedBigInteger* a, const unsignedBigInteger& modulus, unsignedBigInteger* results, unsigned int count,
+	threadPool* pool)
+{
+	barrettReducer reducer(modulus); // a modulus of 0 is reported here, and all the results are 0
+	RunBatch(count, pool, results, [&](unsigned int i) { return reducer.Reduce(a[i]); });
+}
+
+void BatchModPow(const unsignedBigInteger* bases, const unsignedBigInteger* exponents, const unsignedBigInteger& modulus,
+	unsignedBigInteger* results, unsigned int count, threadPool* pool)
+{
+	if (modulus == 0) {
+		printf("DEBUG: An error occurred during modular exponentiation: Division by 0!\n");
+		for (unsigned int i = 0; i < count; i++)
+			results[i] = 0;
+		return;
+	}
+
+	if (modulus > 1 && modulus % 2 == 1) {
+		montgomeryContext context(modulus);
+		RunBatch(count, pool, results, [&](unsigned int i) { return context.Power(bases[i], exponents[i]); });
+		return;
+	}
+	RunBatch(count, pool, results, [&](unsigned int i) { return ModPow(bases[i], exponents[i], modulus); });
+}
@@ -1,6 +1,9 @@
 #include <stdio.h>
 #include <vector>
 #include <string>
+#include <functional>
+#include <array>
+#include <utility>
 
 #pragma once
 
@@ -18,6 +21,190 @@ constexpr auto HIGH_WORD	= 0xFFFF0000;
 
 constexpr auto ABSOLUTE_MAX_SIZE = 134217728;
 
+// Number of 64-bit elements that are stored inside each unsignedBigInteger itself (without allocating memory),
+// so numbers up to (64 * BIG_INTEGER_INLINE_LIMBS) bits never use the heap. It can be changed by defining it before including this file.
+#ifndef BIG_INTEGER_INLINE_LIMBS
+#define BIG_INTEGER_INLINE_LIMBS 4
+#endif
+constexpr unsigned int INLINE_LIMBS = BIG_INTEGER_INLINE_LIMBS;
+static_assert(INLINE_LIMBS >= 1, "At least 1 element should be stored inline");
+
+//=========================================================================================================================
+// Limb Allocators:
+// The memory of the numbers that do not fit in their inline elements is taken from the allocator of the current thread.
+// By default (nullptr), it uses new[] and delete[]. Each number remembers the allocator of its memory and returns the memory to it,
+// so an allocator must live longer than all the numbers that took memory from it.
+//=========================================================================================================================
+class limbAllocator
+{
+public:
+	virtual ~limbAllocator() {}
+	virtual unsigned long long* Allocate(unsigned int count) = 0;
+	virtual void Deallocate(unsigned long long* elements, unsigned int count) = 0;
+
+	// The allocator used by the current thread for new memory (nullptr for new[] and delete[])
+	static limbAllocator* GetCurrent();
+	static limbAllocator* SetCurrent(limbAllocator* allocator); // returns the previous one
+};
+
+// Sets the allocator of the current thread until the end of the scope (then the previous one is restored)
+class limbAllocatorScope
+{
+public:
+	limbAllocatorScope(limbAllocator* allocator) : previous(limbAllocator::SetCurrent(allocator)) {}
+	~limbAllocatorScope() { limbAllocator::SetCurrent(previous); }
+	limbAllocatorScope(const limbAllocatorScope&) = delete;
+	limbAllocatorScope& operator=(const limbAllocatorScope&) = delete;
+
+private:
+	limbAllocator* previous;
+};
+
+// Bump allocator: the memory is taken from big blocks one after another, and nothing is freed until Reset() frees all of it at once.
+// The numbers that took memory from it must not be used after Reset() (except for assigning new values to them or destroying them).
+class limbArena : public limbAllocator
+{
+public:
+	limbArena(unsigned int blockSize = 65536); // in 64-bit elements (512 KB)
+	~limbArena();
+	limbArena(const limbArena&) = delete;
+	limbArena& operator=(const limbArena&) = delete;
+
+	unsigned long long* Allocate(unsigned int count);
+	void Deallocate(unsigned long long* elements, unsigned int count);
+	void Reset();
+
+private:
+	std::vector<unsigned long long*> blocks;
+	unsigned long long* position = nullptr;
+	unsigned int remaining = 0;
+	unsigned int blockSize;
+};
+
+// Size-class pool: the sizes are rounded up to powers of 2, and the freed memory is kept in a list for each size to be reused.
+// The kept memory is freed by Release() or when the pool is destroyed.
+class limbPool : public limbAllocator
+{
+public:
+	limbPool() {}
+	~limbPool();
+	limbPool(const limbPool&) = delete;
+	limbPool& operator=(const limbPool&) = delete;
+
+	unsigned long long* Allocate(unsigned int count);
+	void Deallocate(unsigned long long* elements, unsigned int count);
+	void Release();
+
+	static constexpr unsigned int SMALLEST_CLASS = 8;		// the smallest size class (in 64-bit elements)
+	static constexpr unsigned int SIZE_CLASSES = 16;		// sizes above (SMALLEST_CLASS << 15) are not kept
+
+private:
+	static unsigned int SizeClass(unsigned int count);
+	std::vector<unsigned long long*> freeLists[SIZE_CLASSES];
+};
+
+//=========================================================================================================================
+// Thread Pool:
+// Multiplication runs on a single thread unless a thread pool is set for the current thread. Then the products of operands
+// of at least GetParallelThreshold() elements are split across the threads of the pool (the NTT transforms and their pointwise
+// products, and the 5 sub-products of Toom-3), so the small products never pay for the threads.
+// The calling thread works too while waiting, and idle threads steal work from the queues of the busy ones.
+//=========================================================================================================================
+struct ThreadPoolState; // defined in the .cpp file
+
+class threadPool
+{
+public:
+	threadPool(unsigned int threads = 0, unsigned int parallelThreshold = 16384); // 0 threads for all the hardware threads
+	~threadPool();
+	threadPool(const threadPool&) = delete;
+	threadPool& operator=(const threadPool&) = delete;
+
+	unsigned int GetThreads() const;			// including the calling thread
+	unsigned int GetParallelThreshold() const;	// in 64-bit elements of the smaller operand
+	void SetParallelThreshold(unsigned int parallelThreshold);
+
+	// Calls task(0), task(1), ..., task(count - 1) on the threads of the pool, and returns after all of them are done
+	void ForEach(unsigned int count, const std::function<void(unsigned int)>& task);
+
+	// The pool used by the current thread for multiplication (nullptr for a single thread).
+	// The threads of a pool use it themselves, so the parts of a product can be split again.
+	static threadPool* GetCurrent();
+	static threadPool* SetCurrent(threadPool* pool); // returns the previous one
+
+private:
+	ThreadPoolState* state;
+	unsigned int parallelThreshold;
+};
+
+// Sets the thread pool of the current thread until the end of the scope (then the previous one is restored)
+class threadPoolScope
+{
+public:
+	threadPoolScope(threadPool* pool) : previous(threadPool::SetCurrent(pool)) {}
+	~threadPoolScope() { threadPool::SetCurrent(previous); }
+	threadPoolScope(const threadPoolScope&) = delete;
+	threadPoolScope& operator=(const threadPoolScope&) = delete;
+
+private:
+	threadPool* previous;
+};
+
+//=========================================================================================================================
+// Limb Storage:
+// A vector of 64-bit elements which keeps up to INLINE_LIMBS elements in the object itself, and moves to the heap when it grows.
+// It has the same functions as std::vector that are used for binaryContents.
+//=========================================================================================================================
+class limbVector
+{
+public:
+	limbVector() : elements(inlineElements), count(0), capacity(INLINE_LIMBS) {}
+	limbVector(const limbVector&);
+	limbVector(limbVector&&) noexcept; // (other) is left empty
+	~limbVector();
+
+	limbVector& operator=(const limbVector&);
+	limbVector& operator=(limbVector&&) noexcept;
+
+	unsigned int size() const { return count; }
+	unsigned long long* data() { return elements; }
+	const unsigned long long* data() const { return elements; }
+	unsigned long long* begin() { return elements; }
+	unsigned long long* end() { return elements + count; }
+	const unsigned long long* begin() const { return elements; }
+	const unsigned long long* end() const { return elements + count; }
+
+	unsigned long long& operator[](unsigned int index) { return elements[index]; }
+	unsigned long long operator[](unsigned int index) const { return elements[index]; }
+	unsigned long long& back() { return elements[count - 1]; }
+	unsigned long long back() const { return elements[count - 1]; }
+
+	void push_back(unsigned long long value) {
+		if (count == capacity)
+			reserve(2 * capacity);
+		elements[count++] = value;
+	}
+	void pop_back() { count--; }
+
+	void resize(unsigned int newSize);						// new elements are set to 0
+	void reserve(unsigned int newCapacity);
+	void assign(const unsigned long long* values, unsigned int size);
+	void swap(limbVector& other);
+
+private:
+	bool IsInline() const { return elements == inlineElements; }
+	void Release();
+
+	unsigned long long* elements;							// points to inlineElements, or to the heap for bigger sizes
+	unsigned int count;
+	unsigned int capacity;
+	limbAllocator* allocator = nullptr;						// where the heap memory came from (nullptr for new[])
+	unsigned long long inlineElements[INLINE_LIMBS];
+};
+
+class barrettReducer;
+template <unsigned int Bits> class fixedBigInteger;
+
 class unsignedBigInteger
 {
 //=========================================================================================================================
@@ -26,6 +213,7 @@ class unsignedBigInteger
 public:
 	unsignedBigInteger();
 	unsignedBigInteger(const unsignedBigInteger&);
+	unsignedBigInteger(unsignedBigInteger&&) noexcept; // (other) is left as 0
 	unsignedBigInteger(unsigned long long);
 
 	unsignedBigInteger(std::string, int base = 10); // Allowing the base to be decimal or hexadecimal
@@ -37,32 +225,43 @@ public:
 //=========================================================================================================================
 public:
 	unsignedBigInteger& operator=(const unsignedBigInteger&);
+	unsignedBigInteger& operator=(unsignedBigInteger&&) noexcept;
 	unsignedBigInteger& operator=(unsigned long long);
 
 	// This function accesses the binaryContents by reference (simpler code)
-	inline unsigned long long& operator[](unsigned int);
+	unsigned long long& operator[](unsigned int);
+	unsigned long long operator[](unsigned int) const;
 
 //=========================================================================================================================
 // Arithmatic Operators (+, -, *, /, %, +=, -=, *=, /=, %=, ++, --) and Arithmatic Functions:
 //=========================================================================================================================
 public:
-	unsignedBigInteger operator+(unsignedBigInteger&);
-	unsignedBigInteger operator-(unsignedBigInteger&);
-	unsignedBigInteger operator*(unsignedBigInteger&);
-	unsignedBigInteger operator/(unsignedBigInteger&);
-	unsignedBigInteger operator%(unsignedBigInteger&);
-
-	unsignedBigInteger operator+(unsigned long long);
-	unsignedBigInteger operator-(unsigned long long);
-	unsignedBigInteger operator*(unsigned long long);
-	unsignedBigInteger operator/(unsigned long long);
-	unsignedBigInteger operator%(unsigned long long);
-
-	unsignedBigInteger& operator+=(unsignedBigInteger&);
-	unsignedBigInteger& operator-=(unsignedBigInteger&);
-	unsignedBigInteger& operator*=(unsignedBigInteger&);
-	unsignedBigInteger& operator/=(unsignedBigInteger&);
-	unsignedBigInteger& operator%=(unsignedBigInteger&);
+	// The overloads called on temporaries (&&) or with temporary inputs (unsignedBigInteger&&) reuse their contents for the result
+	unsignedBigInteger operator+(const unsignedBigInteger&) const&;
+	unsignedBigInteger operator+(const unsignedBigInteger&) &&;
+	unsignedBigInteger operator+(unsignedBigInteger&&) const&;
+	unsignedBigInteger operator+(unsignedBigInteger&&) &&;
+	unsignedBigInteger operator-(const unsignedBigInteger&) const&;
+	unsignedBigInteger operator-(const unsignedBigInteger&) &&;
+	unsignedBigInteger operator*(const unsignedBigInteger&) const;
+	unsignedBigInteger operator/(const unsignedBigInteger&) const;
+	unsignedBigInteger operator%(const unsignedBigInteger&) const;
+
+	unsignedBigInteger operator+(unsigned long long) const&;
+	unsignedBigInteger operator+(unsigned long long) &&;
+	unsignedBigInteger operator-(unsigned long long) const&;
+	unsignedBigInteger operator-(unsigned long long) &&;
+	unsignedBigInteger operator*(unsigned long long) const&;
+	unsignedBigInteger operator*(unsigned long long) &&;
+	unsignedBigInteger operator/(unsigned long long) const&;
+	unsignedBigInteger operator/(unsigned long long) &&;
+	unsignedBigInteger operator%(unsigned long long) const;
+
+	unsignedBigInteger& operator+=(const unsignedBigInteger&);
+	unsignedBigInteger& operator-=(const unsignedBigInteger&);
+	unsignedBigInteger& operator*=(const unsignedBigInteger&);
+	unsignedBigInteger& operator/=(const unsignedBigInteger&);
+	unsignedBigInteger& operator%=(const unsignedBigInteger&);
 
 	unsignedBigInteger& operator+=(unsigned long long);
 	unsignedBigInteger& operator-=(unsigned long long);
@@ -70,56 +269,99 @@ public:
 	unsignedBigInteger& operator/=(unsigned long long);
 	unsignedBigInteger& operator%=(unsigned long long);
 
+	// Modulo a fixed number by the reducer's precalculated reciprocal (no division)
+	unsignedBigInteger operator%(const barrettReducer&) const;
+	unsignedBigInteger& operator%=(const barrettReducer&);
+
 	unsignedBigInteger& operator++();
 	unsignedBigInteger& operator--();
 
 	// Divide functions return whether the operation was successful
-	friend bool Divide(unsignedBigInteger& dividend, unsignedBigInteger& divisor,
+	friend bool Divide(const unsignedBigInteger& dividend, const unsignedBigInteger& divisor,
 		unsignedBigInteger& quotient, unsignedBigInteger& remainder);
-	friend bool Divide(unsignedBigInteger& dividend, unsigned int& divisor,
+	friend bool Divide(const unsignedBigInteger& dividend, const unsigned long long& divisor,
+		unsignedBigInteger& quotient, unsigned long long& remainder);
+	friend bool Divide(const unsignedBigInteger& dividend, const unsigned int& divisor,
 		unsignedBigInteger& quotient, unsigned int& remainder);
 
 	unsignedBigInteger& FastPower(unsigned long long exponent);
-	unsignedBigInteger& FastPower(unsignedBigInteger& exponent);
+	unsignedBigInteger& FastPower(const unsignedBigInteger& exponent);
+	unsignedBigInteger& Square();	// (*this) = (*this) * (*this) in about 2/3 of the time of a general multiplication
+	unsignedBigInteger& SquareRoot();					// (*this) = floor(sqrt(*this))
+	unsignedBigInteger& Root(unsigned long long k);		// (*this) = floor((*this) ^ (1/k)), by Newton's method
+	friend unsignedBigInteger GCD(const unsignedBigInteger& a, const unsignedBigInteger& b);	// Greatest Common Divisor
+	// Returns GCD(a, b) and the smallest x > 0 and y with a * x - b * y = GCD(a, b) (or x = y = 0 if a = 0 and b > 0)
+	friend unsignedBigInteger ExtendedGCD(const unsignedBigInteger& a, const unsignedBigInteger& b, unsignedBigInteger& x, unsignedBigInteger& y);
+
+	// Products by balanced trees, so the multiplications get operands of about equal sizes
+	friend unsignedBigInteger Product(const std::vector<unsignedBigInteger>& values);
+	friend unsignedBigInteger Factorial(unsigned long long n);
+	friend unsignedBigInteger Primorial(unsigned long long n);	// the product of the primes up to n
+	friend unsignedBigInteger Binomial(unsigned long long n, unsigned long long k);
+
+	// (base ^ exponent) mod modulus, without calculating the whole power (see montgomeryContext)
+	friend unsignedBigInteger ModPow(const unsignedBigInteger& base, const unsignedBigInteger& exponent, const unsignedBigInteger& modulus);
+	// a^-1 mod modulus, or 0 if GCD(a, modulus) is not 1
+	friend unsignedBigInteger ModInverse(const unsignedBigInteger& a, const unsignedBigInteger& modulus);
+
+	// Trial division by the small primes, then Miller-Rabin to (rounds) bases (a composite number passes with a probability of at most 4^-rounds)
+	bool IsProbablePrime(unsigned int rounds = 25) const;
+	unsignedBigInteger NextPrime(unsigned int rounds = 25) const;	// the smallest (probable) prime greater than (*this)
+
+private:
+	bool IsStrongProbablePrime(unsigned int rounds) const;	// Miller-Rabin only, for odd numbers greater than 3
+	static unsignedBigInteger IntegerRoot(unsignedBigInteger& n, unsigned long long k);	// floor(n^(1/k)) for k >= 2 (see Root)
 
 //=========================================================================================================================
 // Comparison Operators (<, <=, >, >=, ==, !=) and Comparison Functions:
 //=========================================================================================================================
 public:
-	bool operator< (unsignedBigInteger&);
-	bool operator<=(unsignedBigInteger&);
-	bool operator> (unsignedBigInteger&);
-	bool operator>=(unsignedBigInteger&);
-	bool operator==(unsignedBigInteger&);
-	bool operator!=(unsignedBigInteger&);
-
-	bool operator< (unsigned long long);
-	bool operator<=(unsigned long long);
-	bool operator> (unsigned long long);
-	bool operator>=(unsigned long long);
-	bool operator==(unsigned long long);
-	bool operator!=(unsigned long long);
+	bool operator< (const unsignedBigInteger&) const;
+	bool operator<=(const unsignedBigInteger&) const;
+	bool operator> (const unsignedBigInteger&) const;
+	bool operator>=(const unsignedBigInteger&) const;
+	bool operator==(const unsignedBigInteger&) const;
+	bool operator!=(const unsignedBigInteger&) const;
+
+	bool operator< (unsigned long long) const;
+	bool operator<=(unsigned long long) const;
+	bool operator> (unsigned long long) const;
+	bool operator>=(unsigned long long) const;
+	bool operator==(unsigned long long) const;
+	bool operator!=(unsigned long long) const;
 
 private:
 	// Main Comparison Functions: (all comparison operators call them)
-	signed int CompareWith(unsignedBigInteger&);
-	signed int CompareWith(unsigned long long);
+	signed int CompareWith(const unsignedBigInteger&) const;
+	signed int CompareWith(unsigned long long) const;
 	
 //=========================================================================================================================
 // Bitwise Operators (|, &, ^, |=, &=, ^=, ~) :
 //=========================================================================================================================
 public:
-	unsignedBigInteger operator|(unsignedBigInteger&);
-	unsignedBigInteger operator&(unsignedBigInteger&);
-	unsignedBigInteger operator^(unsignedBigInteger&);
-
-	unsignedBigInteger operator|(unsigned long long);
-	unsignedBigInteger operator&(unsigned long long);
-	unsignedBigInteger operator^(unsigned long long);
-
-	unsignedBigInteger& operator|=(unsignedBigInteger&);
-	unsignedBigInteger& operator&=(unsignedBigInteger&);
-	unsignedBigInteger& operator^=(unsignedBigInteger&);
+	// The overloads called on temporaries (&&) or with temporary inputs (unsignedBigInteger&&) reuse their contents for the result
+	unsignedBigInteger operator|(const unsignedBigInteger&) const&;
+	unsignedBigInteger operator|(const unsignedBigInteger&) &&;
+	unsignedBigInteger operator|(unsignedBigInteger&&) const&;
+	unsignedBigInteger operator|(unsignedBigInteger&&) &&;
+	unsignedBigInteger operator&(const unsignedBigInteger&) const&;
+	unsignedBigInteger operator&(const unsignedBigInteger&) &&;
+	unsignedBigInteger operator&(unsignedBigInteger&&) const&;
+	unsignedBigInteger operator&(unsignedBigInteger&&) &&;
+	unsignedBigInteger operator^(const unsignedBigInteger&) const&;
+	unsignedBigInteger operator^(const unsignedBigInteger&) &&;
+	unsignedBigInteger operator^(unsignedBigInteger&&) const&;
+	unsignedBigInteger operator^(unsignedBigInteger&&) &&;
+
+	unsignedBigInteger operator|(unsigned long long) const&;
+	unsignedBigInteger operator|(unsigned long long) &&;
+	unsignedBigInteger operator&(unsigned long long) const;
+	unsignedBigInteger operator^(unsigned long long) const&;
+	unsignedBigInteger operator^(unsigned long long) &&;
+
+	unsignedBigInteger& operator|=(const unsignedBigInteger&);
+	unsignedBigInteger& operator&=(const unsignedBigInteger&);
+	unsignedBigInteger& operator^=(const unsignedBigInteger&);
 
 	unsignedBigInteger& operator|=(unsigned long long);
 	unsignedBigInteger& operator&=(unsigned long long);
@@ -131,17 +373,22 @@ public:
 // Shift Operators (<<, >>, <<=, >>=) and Shifting Functions:
 //=========================================================================================================================
 public:
-	unsignedBigInteger operator<<(unsigned long long);
-	unsignedBigInteger operator>>(unsigned long long);
+	// The overloads called on temporaries (&&) shift their contents in-place for the result
+	unsignedBigInteger operator<<(unsigned long long) const&;
+	unsignedBigInteger operator<<(unsigned long long) &&;
+	unsignedBigInteger operator>>(unsigned long long) const&;
+	unsignedBigInteger operator>>(unsigned long long) &&;
 
-	unsignedBigInteger operator<<(unsignedBigInteger&);
-	unsignedBigInteger operator>>(unsignedBigInteger&);
+	unsignedBigInteger operator<<(const unsignedBigInteger&) const&;
+	unsignedBigInteger operator<<(const unsignedBigInteger&) &&;
+	unsignedBigInteger operator>>(const unsignedBigInteger&) const&;
+	unsignedBigInteger operator>>(const unsignedBigInteger&) &&;
 
 	unsignedBigInteger& operator<<=(unsigned long long);
 	unsignedBigInteger& operator>>=(unsigned long long);
 
-	unsignedBigInteger& operator<<=(unsignedBigInteger&);
-	unsignedBigInteger& operator>>=(unsignedBigInteger&);
+	unsignedBigInteger& operator<<=(const unsignedBigInteger&);
+	unsignedBigInteger& operator>>=(const unsignedBigInteger&);
 
 private:
 	// Shift by the number of 64-bit elements
@@ -163,21 +410,20 @@ public:
 public:
 	unsigned int NumberOfDigits();
 	unsigned int NumberOfBits();
-	inline unsigned unsigned long long Size();
-	inline unsigned unsigned long long GetMaximumSize();
+	inline unsigned long long Size() const;
+	inline unsigned long long GetMaximumSize() const;
 
 private:
 	bool Resize(unsigned int newSize, bool extendMaxSize = false);
 	bool ShrinkContents();
-	std::vector<unsigned long long> GetExpandedContents();  // This function will get a vector of the binaryContents after expansion (every 32-bit in a different element)
 	unsigned int RemoveTrailingZeros();				        // return the number of trailing zeros and remove them (helpful for multiplication and division)
 
 //=========================================================================================================================
 // Converting Functions:
 //=========================================================================================================================
 public:
-	inline unsigned int ToUInt();
-	inline unsigned long long ToULongLong();
+	inline unsigned int ToUInt() const;
+	inline unsigned long long ToULongLong() const;
 	std::string ConvertToString(unsigned int base); // valid values for base are only 10 and 16
 	bool ConvertToDecimal();
 	bool ConvertFromStringDecimal(std::string);
@@ -188,7 +434,7 @@ public:
 //=========================================================================================================================
 private:
 	// Quantity Holders:
-	std::vector<unsigned long long> binaryContents;		// each element contains a 64-bit part of the number starting from 0 at least significant
+	limbVector binaryContents;							// each element contains a 64-bit part of the number starting from 0 at least significant
 	std::vector<unsigned int> decimalContents;			// each element contains a 9-digit part of the number starting from 0 at least significant
 
 	// Limits:
@@ -197,9 +443,404 @@ private:
 	unsigned int ABSOLUTE_MAX_SIZE = 134217728;			// up to 134217728 x 8	bytes for binaryContents ( 1  GB)
 	//*/
 
-	// Flags to check what to do with decimalContents: [TODO: Un-implemented functionality]
-	bool isConvertedToDecimal = false;		// This will be true if decimalContents actually represent the current number.
-	bool alwaysConvertToDecimal = false;	// If this is true, all operations will change the value of decimalContents.
+	// Flags to check what to do with decimalContents:
+	bool isConvertedToDecimal = false;		// This will be true if decimalContents actually represent the current number. Every change of the value sets it to false.
+	bool alwaysConvertToDecimal = false;	// If this is true, all operations will change the value of decimalContents. [TODO: Un-implemented functionality]
+
+	friend class montgomeryContext;
+	friend class barrettReducer;
+	template <unsigned int Bits> friend class fixedBigInteger;
+};
+
+// These may take no unsignedBigInteger arguments, so they are declared here too (to be found outside the class)
+unsignedBigInteger Product(const std::vector<unsignedBigInteger>& values);
+unsignedBigInteger Factorial(unsigned long long n);
+unsignedBigInteger Primorial(unsigned long long n);
+unsignedBigInteger Binomial(unsigned long long n, unsigned long long k);
+
+//=========================================================================================================================
+// Modular Arithmetic:
+// A context for calculations modulo the same odd number, which keeps the numbers in the Montgomery form (x * R mod modulus),
+// where R = 2^(64 * number of elements of the modulus). Everything that depends only on the modulus is calculated once by the constructor,
+// so the same context can be used for many calculations (such as all the powers of a primality test).
+//=========================================================================================================================
+class montgomeryContext
+{
+public:
+	montgomeryContext(const unsignedBigInteger& modulus);	// the modulus must be odd and greater than 1
+	bool IsValid() const { return isValid; }
+	const unsignedBigInteger& GetModulus() const { return modulus; }
+
+	// Converting between the normal form and the Montgomery form
+	unsignedBigInteger ToMontgomery(const unsignedBigInteger& x) const;
+	unsignedBigInteger FromMontgomery(const unsignedBigInteger& x) const;
+
+	// The inputs and the results are in the Montgomery form (the multiplication and the reduction are done together)
+	unsignedBigInteger Multiply(const unsignedBigInteger& a, const unsignedBigInteger& b) const;
+	unsignedBigInteger Square(const unsignedBigInteger& a) const;
+
+	// (base ^ exponent) mod modulus, where the base and the result are in the normal form
+	unsignedBigInteger Power(const unsignedBigInteger& base, const unsignedBigInteger& exponent) const;
+
+private:
+	std::vector<unsigned long long> ToLimbs(const unsignedBigInteger& x) const;	// (x mod modulus) in exactly (size) elements
+	unsignedBigInteger FromLimbs(const std::vector<unsigned long long>& limbs) const;
+
+	unsignedBigInteger modulus;
+	unsigned int size = 0;									// the number of 64-bit elements of the modulus
+	unsigned long long inverse = 0;							// -modulus^-1 mod 2^64
+	std::vector<unsigned long long> inverseLimbs;			// -modulus^-1 mod R (only for big moduli)
+	std::vector<unsigned long long> rSquared;				// R^2 mod modulus (to convert into the Montgomery form)
+	bool isValid = false;
+};
+
+// A reducer modulo a fixed number (any number greater than 0), which precalculates 2^(128 * number of elements of the modulus) / modulus,
+// so each reduction of a number of up to twice the size of the modulus takes 2 multiplications and no division (Barrett's reduction).
+// It is used by (x % reducer) and (x %= reducer).
+class barrettReducer
+{
+public:
+	barrettReducer(const unsignedBigInteger& modulus);
+	bool IsValid() const { return isValid; }
+	const unsignedBigInteger& GetModulus() const { return modulus; }
+
+	unsignedBigInteger Reduce(const unsignedBigInteger& x) const;	// x mod modulus (bigger numbers are reduced in parts)
+
+private:
+	unsignedBigInteger modulus;
+	unsigned int size = 0;									// the number of 64-bit elements of the modulus
+	std::vector<unsigned long long> mu;						// 2^(128 * size) / modulus
+	bool isValid = false;
+};
+
+//=========================================================================================================================
+// Batch Operations:
+// Many independent calculations at once: results[i] = the calculation on the i-th inputs, for i from 0 to count - 1.
+// They are split in ranges across the threads of the given pool (or the pool of the current thread if it is nullptr),
+// and they run on the current thread only if there is no pool. The results may be the same array as an input.
+// Each thread takes the memory of the temporary numbers from a limbPool of its own (its scratch, which is kept for the next batches),
+// and the results are copied out of it to memory of new[] (not from the allocator of the current thread), since they are filled
+// on different threads. Their previous memory is freed on those threads too (so it must not be taken from a limbPool).
+//=========================================================================================================================
+void BatchMultiply(const unsignedBigInteger* a, const unsignedBigInteger* b, unsignedBigInteger* results, unsigned int count,
+	threadPool* pool = nullptr);
+// The reducer of the modulus is created once for all the numbers
+void BatchMod(const unsignedBigInteger* a, const unsignedBigInteger& modulus, unsignedBigInteger* results, unsigned int count,
+	threadPool* pool = nullptr);
+// The Montgomery context of an odd modulus is created once for all the powers
+void BatchModPow(const unsignedBigInteger* bases, const unsignedBigInteger* exponents, const unsignedBigInteger& modulus,
+	unsignedBigInteger* results, unsigned int count, threadPool* pool = nullptr);
+
+//=========================================================================================================================
+// Fixed-Width Integers:
+// A number of exactly (Bits / 64) elements in a std::array, for values of a known width (256, 512, 4096 bits, ...).
+// It never allocates memory and has no size checks, so it can live on the stack, and all of its operators are constexpr.
+// The arithmetic is modulo 2^Bits (the carries out of the highest element are dropped), like the built-in unsigned integers.
+// The conversions from and to unsignedBigInteger are explicit (a bigger unsignedBigInteger keeps only its lowest Bits bits).
+//=========================================================================================================================
+template <unsigned int Bits>
+class fixedBigInteger
+{
+	static_assert(Bits > 0 && Bits % 64 == 0, "The number of bits must be a multiple of 64");
+
+public:
+	static constexpr unsigned int LIMBS = Bits / 64;
+
+	constexpr fixedBigInteger() : limbs{} {}
+	constexpr fixedBigInteger(unsigned long long value) : limbs{} { limbs[0] = value; }
+	template <unsigned int OtherBits>
+	constexpr explicit fixedBigInteger(const fixedBigInteger<OtherBits>& other);	// keeps only the lowest Bits bits of a wider number
+	explicit fixedBigInteger(const unsignedBigInteger& other);
+	explicit operator unsignedBigInteger() const;
+
+	// The 64-bit element at (index), starting from 0 at least significant
+	constexpr unsigned long long operator[](unsigned int index) const { return limbs[index]; }
+
+	constexpr fixedBigInteger operator+(const fixedBigInteger& other) const { fixedBigInteger result(*this); return result += other; }
+	constexpr fixedBigInteger operator-(const fixedBigInteger& other) const { fixedBigInteger result(*this); return result -= other; }
+	constexpr fixedBigInteger operator*(const fixedBigInteger& other) const;
+	constexpr fixedBigInteger operator<<(unsigned int shift) const;
+	constexpr fixedBigInteger operator>>(unsigned int shift) const;
+	constexpr fixedBigInteger operator&(const fixedBigInteger& other) const;
+	constexpr fixedBigInteger operator|(const fixedBigInteger& other) const;
+	constexpr fixedBigInteger operator^(const fixedBigInteger& other) const;
+	constexpr fixedBigInteger operator~() const;
+
+	constexpr fixedBigInteger& operator+=(const fixedBigInteger& other) { AddAll(other, std::make_index_sequence<LIMBS>()); return *this; }
+	constexpr fixedBigInteger& operator-=(const fixedBigInteger& other) { SubtractAll(other, std::make_index_sequence<LIMBS>()); return *this; }
+	constexpr fixedBigInteger& operator*=(const fixedBigInteger& other) { return *this = *this * other; }
+	constexpr fixedBigInteger& operator<<=(unsigned int shift) { return *this = *this << shift; }
+	constexpr fixedBigInteger& operator>>=(unsigned int shift) { return *this = *this >> shift; }
+	constexpr fixedBigInteger& operator&=(const fixedBigInteger& other) { return *this = *this & other; }
+	constexpr fixedBigInteger& operator|=(const fixedBigInteger& other) { return *this = *this | other; }
+	constexpr fixedBigInteger& operator^=(const fixedBigInteger& other) { return *this = *this ^ other; }
+	constexpr fixedBigInteger& operator++() { return *this += 1; }
+	constexpr fixedBigInteger& operator--() { return *this -= 1; }
+
+	constexpr bool operator< (const fixedBigInteger& other) const { return CompareWith(other) < 0; }
+	constexpr bool operator<=(const fixedBigInteger& other) const { return CompareWith(other) <= 0; }
+	constexpr bool operator> (const fixedBigInteger& other) const { return CompareWith(other) > 0; }
+	constexpr bool operator>=(const fixedBigInteger& other) const { return CompareWith(other) >= 0; }
+	constexpr bool operator==(const fixedBigInteger& other) const { return CompareWith(other) == 0; }
+	constexpr bool operator!=(const fixedBigInteger& other) const { return CompareWith(other) != 0; }
+
+private:
+	constexpr signed int CompareWith(const fixedBigInteger& other) const;
+
+	// Single-element steps (in portable code, so they can run at compile time)
+	static constexpr unsigned long long AddStep(unsigned long long a, unsigned long long b, unsigned long long& carry);
+	static constexpr unsigned long long SubtractStep(unsigned long long a, unsigned long long b, unsigned long long& borrow);
+	static constexpr unsigned long long MultiplyAddStep(unsigned long long a, unsigned long long b, unsigned long long c, unsigned long long& carry);
+
+	// The additions and subtractions are fully unrolled (a step for each element) by expanding the indices at compile time
+	template <std::size_t... I>
+	constexpr void AddAll(const fixedBigInteger& other, std::index_sequence<I...>)
+	{
+		unsigned long long carry = 0;
+		((limbs[I] = AddStep(limbs[I], other.limbs[I], carry)), ...);
+	}
+	template <std::size_t... I>
+	constexpr void SubtractAll(const fixedBigInteger& other, std::index_sequence<I...>)
+	{
+		unsigned long long borrow = 0;
+		((limbs[I] = SubtractStep(limbs[I], other.limbs[I], borrow)), ...);
+	}
+
+	std::array<unsigned long long, LIMBS> limbs;	// starting from 0 at least significant
 };
 
+template <unsigned int Bits>
+template <unsigned int OtherBits>
+constexpr fixedBigInteger<Bits>::fixedBigInteger(const fixedBigInteger<OtherBits>& other) : limbs{}
+{
+	for (unsigned int i = 0; i < LIMBS && i < fixedBigInteger<OtherBits>::LIMBS; i++)
+		limbs[i] = other[i];
+}
+
+template <unsigned int Bits>
+fixedBigInteger<Bits>::fixedBigInteger(const unsignedBigInteger& other) : limbs{}
+{
+	unsigned int count = other.binaryContents.size() < LIMBS ? other.binaryContents.size() : LIMBS;
+	for (unsigned int i = 0; i < count; i++)
+		limbs[i] = other.binaryContents[i];
+}
+
+template <unsigned int Bits>
+fixedBigInteger<Bits>::operator unsignedBigInteger() const
+{
+	unsignedBigInteger result;
+	result.isConvertedToDecimal = false;
+	result.Resize(LIMBS, true);
+	for (unsigned int i = 0; i < LIMBS; i++)
+		result.binaryContents[i] = limbs[i];
+	result.ShrinkContents();
+	return result;
+}
+
+// Only the lower half of the product is calculated: result[i + j] += a[i] * b[j] for (i + j < LIMBS)
+template <unsigned int Bits>
+constexpr fixedBigInteger<Bits> fixedBigInteger<Bits>::operator*(const fixedBigInteger& other) const
+{
+	fixedBigInteger result;
+	for (unsigned int i = 0; i < LIMBS; i++) {
+		unsigned long long carry = 0;
+		for (unsigned int j = 0; i + j < LIMBS; j++)
+			result.limbs[i + j] = MultiplyAddStep(limbs[i], other.limbs[j], result.limbs[i + j], carry);
+	}
+	return result;
+}
+
+template <unsigned int Bits>
+constexpr fixedBigInteger<Bits> fixedBigInteger<Bits>::operator<<(unsigned int shift) const
+{
+	fixedBigInteger result;
+	if (shift >= Bits)
+		return result;
+	unsigned int limbShift = shift / 64, bitShift = shift % 64;
+	for (unsigned int i = limbShift; i < LIMBS; i++) {
+		result.limbs[i] = limbs[i - limbShift] << bitShift;
+		if (bitShift != 0 && i > limbShift)
+			result.limbs[i] |= limbs[i - limbShift - 1] >> (64 - bitShift);
+	}
+	return result;
+}
+
+template <unsigned int Bits>
+constexpr fixedBigInteger<Bits> fixedBigInteger<Bits>::operator>>(unsigned int shift) const
+{
+	fixedBigInteger result;
+	if (shift >= Bits)
+		return result;
+	unsigned int limbShift = shift / 64, bitShift = shift % 64;
+	for (unsigned int i = 0; i + limbShift < LIMBS; i++) {
+		result.limbs[i] = limbs[i + limbShift] >> bitShift;
+		if (bitShift != 0 && i + limbShift + 1 < LIMBS)
+			result.limbs[i] |= limbs[i + limbShift + 1] << (64 - bitShift);
+	}
+	return result;
+}
+
+template <unsigned int Bits>
+constexpr fixedBigInteger<Bits> fixedBigInteger<Bits>::operator&(const fixedBigInteger& other) const
+{
+	fixedBigInteger result;
+	for (unsigned int i = 0; i < LIMBS; i++)
+		result.limbs[i] = limbs[i] & other.limbs[i];
+	return result;
+}
+
+template <unsigned int Bits>
+constexpr fixedBigInteger<Bits> fixedBigInteger<Bits>::operator|(const fixedBigInteger& other) const
+{
+	fixedBigInteger result;
+	for (unsigned int i = 0; i < LIMBS; i++)
+		result.limbs[i] = limbs[i] | other.limbs[i];
+	return result;
+}
+
+template <unsigned int Bits>
+constexpr fixedBigInteger<Bits> fixedBigInteger<Bits>::operator^(const fixedBigInteger& other) const
+{
+	fixedBigInteger result;
+	for (unsigned int i = 0; i < LIMBS; i++)
+		result.limbs[i] = limbs[i] ^ other.limbs[i];
+	return result;
+}
+
+template <unsigned int Bits>
+constexpr fixedBigInteger<Bits> fixedBigInteger<Bits>::operator~() const
+{
+	fixedBigInteger result;
+	for (unsigned int i = 0; i < LIMBS; i++)
+		result.limbs[i] = ~limbs[i];
+	return result;
+}
+
+template <unsigned int Bits>
+constexpr signed int fixedBigInteger<Bits>::CompareWith(const fixedBigInteger& other) const
+{
+	for (unsigned int i = LIMBS; i-- > 0; )
+		if (limbs[i] != other.limbs[i])
+			return limbs[i] < other.limbs[i] ? -1 : 1;
+	return 0;
+}
+
+// a + b + carry, and the new carry (0 or 1)
+template <unsigned int Bits>
+constexpr unsigned long long fixedBigInteger<Bits>::AddStep(unsigned long long a, unsigned long long b, unsigned long long& carry)
+{
+	unsigned long long sum = a + carry;
+	unsigned long long carryOut = sum < carry;
+	sum += b;
+	carry = carryOut | (sum < b);
+	return sum;
+}
+
+// a - b - borrow, and the new borrow (0 or 1)
+template <unsigned int Bits>
+constexpr unsigned long long fixedBigInteger<Bits>::SubtractStep(unsigned long long a, unsigned long long b, unsigned long long& borrow)
+{
+	unsigned long long difference = a - borrow;
+	unsigned long long borrowOut = a < borrow;
+	borrowOut |= difference < b;
+	borrow = borrowOut;
+	return difference - b;
+}
+
+// The lower 64 bits of (a * b + c + carry), and its higher 64 bits go to carry (the sum always fits in 128 bits)
+template <unsigned int Bits>
+constexpr unsigned long long fixedBigInteger<Bits>::MultiplyAddStep(unsigned long long a, unsigned long long b, unsigned long long c,
+	unsigned long long& carry)
+{
+#if defined(__SIZEOF_INT128__)
+	unsigned __int128 sum = (unsigned __int128)a * b + c + carry;
+	carry = (unsigned long long)(sum >> 64);
+	return (unsigned long long)sum;
+#else
+	// By 32-bit halves: a * b = aHigh * bHigh * 2^64 + (aLow * bHigh + aHigh * bLow) * 2^32 + aLow * bLow
+	unsigned long long aLow = a & LOW_DWORD, aHigh = a >> 32, bLow = b & LOW_DWORD, bHigh = b >> 32;
+	unsigned long long lowLow = aLow * bLow, lowHigh = aLow * bHigh, highLow = aHigh * bLow;
+	unsigned long long middle = (lowLow >> 32) + (lowHigh & LOW_DWORD) + (highLow & LOW_DWORD);
+	unsigned long long low = (lowLow & LOW_DWORD) | (middle << 32);
+	unsigned long long high = aHigh * bHigh + (lowHigh >> 32) + (highLow >> 32) + (middle >> 32);
+	low += c;
+	high += low < c;
+	low += carry;
+	high += low < carry;
+	carry = high;
+	return low;
+#endif
+}
+
+//=========================================================================================================================
+// Integer Literals:
+// 123456789012345678901234567890_ubi is an unsignedBigInteger, and 123456789012345678901234567890_fixed is a constexpr fixedBigInteger.
+// The literals can be decimal, hexadecimal (0x), binary (0b) or octal (leading 0), with digit separators (').
+// Their digits are parsed at compile time into the limbs of a fixedBigInteger, which is wide enough for any literal with that many digits
+// (so a _fixed constant costs nothing at run time, and a _ubi number only copies the limbs, without any conversion from a string).
+//=========================================================================================================================
+template <char... Characters>
+class integerLiteral
+{
+	static constexpr char characters[] = { Characters... };
+	static constexpr unsigned int COUNT = sizeof...(Characters);
+	static constexpr bool HAS_PREFIX = COUNT > 2 && characters[0] == '0' &&
+		(characters[1] == 'x' || characters[1] == 'X' || characters[1] == 'b' || characters[1] == 'B');
+
+public:
+	static constexpr unsigned int BASE = HAS_PREFIX ? (characters[1] == 'x' || characters[1] == 'X' ? 16 : 2) :
+		(COUNT > 1 && characters[0] == '0' ? 8 : 10);
+
+	// An upper bound of the bits of the digits (10 / 3 bits for each decimal digit is more than log2(10)), rounded up to whole elements
+	static constexpr unsigned int BITS = ((BASE == 10 ? ((COUNT * 10 + 2) / 3) : (COUNT - (HAS_PREFIX ? 2 : 0)) *
+		(BASE == 16 ? 4 : BASE == 8 ? 3 : 1)) + 63) / 64 * 64;
+
+	// The value of each digit (BASE for a character that is not a digit of the base, and 0 for the separators)
+	static constexpr unsigned int DigitValue(char character)
+	{
+		unsigned int digit = character >= '0' && character <= '9' ? character - '0' :
+			character >= 'a' && character <= 'f' ? character - 'a' + 10 :
+			character >= 'A' && character <= 'F' ? character - 'A' + 10 : BASE;
+		return character == '\'' ? 0 : digit < BASE ? digit : BASE;
+	}
+
+	static constexpr bool IsValid()
+	{
+		for (unsigned int i = HAS_PREFIX ? 2 : 0; i < COUNT; i++)
+			if (DigitValue(characters[i]) >= BASE)
+				return false;
+		return true;
+	}
+
+	// value = value * BASE + digit for each digit, by shifting (and adding the shifts for 10 = 8 + 2), so each step is linear
+	static constexpr fixedBigInteger<BITS> Parse()
+	{
+		static_assert(IsValid(), "The literal must be an integer");
+		fixedBigInteger<BITS> value;
+		for (unsigned int i = HAS_PREFIX ? 2 : 0; i < COUNT; i++) {
+			if (characters[i] == '\'')
+				continue;
+			if (BASE == 10)
+				value = (value << 3) + (value << 1);
+			else
+				value <<= BASE == 16 ? 4 : BASE == 8 ? 3 : 1;
+			value += DigitValue(characters[i]);
+		}
+		return value;
+	}
+};
+
+template <char... Characters>
+constexpr fixedBigInteger<integerLiteral<Characters...>::BITS> operator""_fixed()
+{
+	return integerLiteral<Characters...>::Parse();
+}
+
+template <char... Characters>
+unsignedBigInteger operator""_ubi()
+{
+	static constexpr fixedBigInteger<integerLiteral<Characters...>::BITS> value = integerLiteral<Characters...>::Parse();
+	return unsignedBigInteger(value);
+}
+
 #endif //  !BIG_INTEGER
@@ -6,19 +6,6 @@
 #include <algorithm>
 #include "BigInteger++.h"
 
-unsignedBigInteger GCD(unsignedBigInteger x, unsignedBigInteger y) {
-    // GCD(x, y) = GCD(y, x % y)
-    if (x == 0)
-        return y;
-    if (y == 0)
-        return x;
-    while (y > 0) {
-        x %= y;
-        std::swap(x, y);
-    }
-    return x;
-}
-
 int main()
 {
     printf("Compiled correctly!\n\n");
@@ -171,11 +158,9 @@ int main()
     }
 
     printf("Printing Primes upto %d:\n", N_primes);
-    unsignedBigInteger product = 1;
-    for (unsigned int p : primes) {
+    for (unsigned int p : primes)
         printf("%d\n", p);
-        product *= p;
-    }
+    unsignedBigInteger product = Primorial(N_primes);
     printf("\nProduct of primes upto %d is:\n", N_primes);
     product.PrintAsDecimal('\n');
     printf("------------------------\n\n");
@@ -189,5 +174,50 @@ int main()
         y.PrintAsDecimal('\n');
         printf("\n");
     }
+    printf("------------------------\n\n");
+
+    printf("Checking numbers above the default maximum size (32768 elements):\n");
+    unsignedBigInteger big1(1), big2(3), small(7), check, expected;
+    big1 <<= 64 * 20000;
+    big1 -= 1;
+    big2 <<= 64 * 20000;
+    big2 += 12345;
+    unsignedBigInteger big = big1 * big2; // about 40000 elements
+    check = big + small;
+    if (check - small != big)
+        printf("Addition or subtraction unsuccessful !\n");
+    check = small;
+    check += big;
+    expected = big + 7;
+    if (check != expected)
+        printf("Addition assignment unsuccessful !\n");
+    check = small;
+    check |= big;
+    expected = big | 7;
+    if (check != expected)
+        printf("Bitwise-or assignment unsuccessful !\n");
+    check = big >> 64;
+    check <<= 64;
+    expected = big & (HIGH_DWORD | LOW_DWORD);
+    check += expected; // the lowest element was cleared
+    if (check != big)
+        printf("Shifting unsuccessful !\n");
+    unsignedBigInteger base = big1 >> 1; // big1 is odd with 20000 elements, so R^2 = 2^(128 * 20000) exceeds the default maximum size
+    if (ModPow(base, 3, big1) != base * base % big1 * base % big1)
+        printf("Modular exponentiation unsuccessful !\n");
+    barrettReducer reducer(big1);
+    if (base * base % reducer != base * base % big1)
+        printf("Barrett reduction unsuccessful !\n");
+    unsignedBigInteger power(1);
+    power <<= 64 * 20000;
+    power *= power; // 2^(64 * 40000)
+    if (GCD(power * 3, power * 9) != power * 3)
+        printf("GCD unsuccessful !\n");
+    if (Factorial(138000) != Factorial(137999) * 138000)
+        printf("Factorial unsuccessful !\n");
+    check = big * big;
+    if (check.SquareRoot() != big)
+        printf("Square root unsuccessful !\n");
+    printf("Done\n");
     return 0;
 }